@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Subspace eigenproblem of the Krylov subspace stochastic reconfiguration.
+*/
+
+#ifndef GQPEPS_ALGORITHM_VMC_UPDATE_KRYLOV_SUBSPACE_SR_H
+#define GQPEPS_ALGORITHM_VMC_UPDATE_KRYLOV_SUBSPACE_SR_H
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+#include "gqpeps/utility/conjugate_elem.h"          //ConjugateElem
+#include "gqpeps/utility/hermitian_eigen_solver.h"  //HermitianEigen
+
+namespace gqpeps {
+
+/**
+ * Generalized eigenproblem of the energy in the span of psi and n parameter directions v_l, built from the samples
+ * of the stochastic reconfiguration only: the directional log-derivatives x_l(S) = sum_k O_k(S) v_lk and the local
+ * energies E_L(S). In the basis of psi and the centered derivatives psi_l - <x_l> psi,
+ *      S_kl = <dx_k^* dx_l>,     H_k0 = <dx_k^* E_L>,     H_kl = <dx_k^* E_L dx_l>,     H_00 = <E_L>,
+ * where dx = x - <x>. The Hermitian part of H_kl is used for the complex local energies.
+ *
+ * This is NOT the linear method of Umrigar, Sorella et al. (PRL 98, 110201 (2007)), whose H_kl has the additional
+ * term <dx_k^* d_l E_L> of the derivatives of the local energies, which are not sampled here. Without it the lowest
+ * root is not the energy minimum of the linearized wavefunction, but an SR step with an approximate curvature,
+ * and the eigenvalue is only an estimate of the energy after the step.
+ *
+ * The stabilization adds shift * S_kl to H_kl, which for a large shift gives the update -S^(-1) H_k0 / shift,
+ * i.e. the stochastic reconfiguration step of length 1 / shift in the subspace.
+ * The generalized eigenproblem is solved after the canonical orthogonalization of S (the directions of
+ * the eigenvalues below kOverlapCutoff times the largest are dropped), and the lowest root whose weight on psi
+ * is at least kMinReferenceWeight is taken, with the normalization c_0 = 1.
+ *
+ * The coefficients c are then turned into the parameter changes by the normalization of J. Toulouse and
+ * C. J. Umrigar (J. Chem. Phys. 126, 084102 (2007)),
+ *      dp = c / (1 + (1 - xi) (D^2 - 1) / (xi D + 1 - xi)),   D^2 = 1 + c^dag S c,
+ * which makes the change orthogonal to xi psi + (1 - xi) psi_lin / D, psi_lin = psi + sum_l c_l (psi_l - <x_l> psi).
+ * xi = 1 takes the linear coefficients as they are, xi = 0 shortens the large steps most.
+ *
+ * The samples are accumulated in one vector of sums, so that they can be reduced by MPI in one call.
+ */
+template<typename ElemT>
+class KrylovSRSubspace {
+ public:
+  explicit KrylovSRSubspace(const size_t n) : n_(n), sums_(2 + 3 * n + 2 * n * n, ElemT(0)) {}
+
+  size_t Dim(void) const { return n_; }
+
+  void AddSample(const ElemT e_loc, const std::vector<ElemT> &x) {
+    sums_[0] += ElemT(1);
+    sums_[1] += e_loc;
+    for (size_t k = 0; k < n_; k++) {
+      const ElemT x_conj = ConjugateElem(x[k]);
+      sums_[XIdx_(k)] += x[k];
+      sums_[XEIdx_(k)] += x_conj * e_loc;
+      sums_[EXIdx_(k)] += e_loc * x[k];
+      for (size_t l = 0; l < n_; l++) {
+        sums_[XXIdx_(k, l)] += x_conj * x[l];
+        sums_[XEXIdx_(k, l)] += x_conj * e_loc * x[l];
+      }
+    }
+  }
+
+  ///< the sums of the samples, e.g. for MPI_Allreduce
+  std::vector<ElemT> &Sums(void) { return sums_; }
+
+  const std::vector<ElemT> &Sums(void) const { return sums_; }
+
+  /**
+   * @param shift         stabilization, H_kl += shift * S_kl
+   * @param xi            normalization of the parameter changes, in [0, 1]
+   * @param param_change  output, the parameter changes along the directions
+   * @param energy        output, the eigenvalue, i.e. the energy predicted in the subspace
+   * @return false if there is no sample, the matrices are not finite, or no root has enough weight on psi
+   */
+  bool Solve(const double shift, const double xi, std::vector<ElemT> &param_change, double &energy) const {
+    const double num = std::real(sums_[0]);
+    if (!(num > 0.0) || n_ == 0) {
+      return false;
+    }
+    const ElemT e = sums_[1] / num;
+    std::vector<ElemT> x(n_), xe(n_), ex(n_);
+    for (size_t k = 0; k < n_; k++) {
+      x[k] = sums_[XIdx_(k)] / num;
+      xe[k] = sums_[XEIdx_(k)] / num;
+      ex[k] = sums_[EXIdx_(k)] / num;
+    }
+    std::vector<ElemT> s_mat(n_ * n_), h_mat(n_ * n_), h_k0(n_);
+    for (size_t k = 0; k < n_; k++) {
+      const ElemT x_conj = ConjugateElem(x[k]);
+      h_k0[k] = xe[k] - x_conj * e;
+      for (size_t l = 0; l < n_; l++) {
+        s_mat[k * n_ + l] = sums_[XXIdx_(k, l)] / num - x_conj * x[l];
+        h_mat[k * n_ + l] = sums_[XEXIdx_(k, l)] / num - x_conj * ex[l] - xe[k] * x[l] + x_conj * x[l] * e;
+      }
+    }
+    for (size_t k = 0; k < n_; k++) {
+      for (size_t l = k; l < n_; l++) {
+        const ElemT h_kl = 0.5 * (h_mat[k * n_ + l] + ConjugateElem(h_mat[l * n_ + k])) + shift * s_mat[k * n_ + l];
+        h_mat[k * n_ + l] = h_kl;
+        h_mat[l * n_ + k] = ConjugateElem(h_kl);
+      }
+    }
+
+    // canonical orthogonalization, X = U w^(-1/2) for the kept eigenpairs (w, U) of S
+    std::vector<double> w;
+    std::vector<ElemT> u, s_copy = s_mat;
+    if (!HermitianEigen(s_copy, n_, w, u) || !(w.back() > 0.0)) {
+      return false;
+    }
+    std::vector<size_t> kept;
+    for (size_t j = 0; j < n_; j++) {
+      if (w[j] > kOverlapCutoff * w.back()) {
+        kept.push_back(j);
+      }
+    }
+    const size_t m = kept.size();
+    std::vector<ElemT> x_mat(n_ * m);
+    for (size_t k = 0; k < n_; k++) {
+      for (size_t j = 0; j < m; j++) {
+        x_mat[k * m + j] = u[k * n_ + kept[j]] / std::sqrt(w[kept[j]]);
+      }
+    }
+
+    // the (m + 1) x (m + 1) Hermitian matrix in the orthonormal basis of psi and X
+    const size_t dim = m + 1;
+    std::vector<ElemT> hx(n_ * m, ElemT(0));  // H X
+    for (size_t k = 0; k < n_; k++) {
+      for (size_t j = 0; j < m; j++) {
+        for (size_t l = 0; l < n_; l++) {
+          hx[k * m + j] += h_mat[k * n_ + l] * x_mat[l * m + j];
+        }
+      }
+    }
+    std::vector<ElemT> reduced(dim * dim, ElemT(0));
+    reduced[0] = std::real(e);
+    for (size_t i = 0; i < m; i++) {
+      ElemT h_i0(0);
+      for (size_t k = 0; k < n_; k++) {
+        h_i0 += ConjugateElem(x_mat[k * m + i]) * h_k0[k];
+      }
+      reduced[(i + 1) * dim] = h_i0;
+      reduced[i + 1] = ConjugateElem(h_i0);
+      for (size_t j = 0; j < m; j++) {
+        ElemT h_ij(0);
+        for (size_t k = 0; k < n_; k++) {
+          h_ij += ConjugateElem(x_mat[k * m + i]) * hx[k * m + j];
+        }
+        reduced[(i + 1) * dim + j + 1] = h_ij;
+      }
+    }
+    std::vector<double> eigvals;
+    std::vector<ElemT> eigvecs;
+    if (!HermitianEigen(reduced, dim, eigvals, eigvecs)) {
+      return false;
+    }
+    size_t root = dim;
+    for (size_t j = 0; j < dim; j++) {
+      if (std::norm(eigvecs[j]) >= kMinReferenceWeight) {
+        root = j;
+        break;
+      }
+    }
+    if (root == dim) {
+      return false;
+    }
+
+    // c = X z / z_0
+    const ElemT z0 = eigvecs[root];
+    std::vector<ElemT> c(n_, ElemT(0));
+    for (size_t k = 0; k < n_; k++) {
+      for (size_t j = 0; j < m; j++) {
+        c[k] += x_mat[k * m + j] * eigvecs[(j + 1) * dim + root];
+      }
+      c[k] /= z0;
+    }
+    double c_norm_sqr = 0.0;  // c^dag S c
+    for (size_t k = 0; k < n_; k++) {
+      for (size_t l = 0; l < n_; l++) {
+        c_norm_sqr += std::real(ConjugateElem(c[k]) * s_mat[k * n_ + l] * c[l]);
+      }
+    }
+    const double d = std::sqrt(1.0 + std::max(c_norm_sqr, 0.0));
+    const double denominator = 1.0 + (1.0 - xi) * (d * d - 1.0) / (xi * d + 1.0 - xi);
+    param_change.resize(n_);
+    for (size_t k = 0; k < n_; k++) {
+      param_change[k] = c[k] / denominator;
+    }
+    energy = eigvals[root];
+    return true;
+  }
+
+  static constexpr double kOverlapCutoff = 1e-10;
+  static constexpr double kMinReferenceWeight = 0.1;
+
+ private:
+  size_t XIdx_(const size_t k) const { return 2 + k; }
+  size_t XEIdx_(const size_t k) const { return 2 + n_ + k; }
+  size_t EXIdx_(const size_t k) const { return 2 + 2 * n_ + k; }
+  size_t XXIdx_(const size_t k, const size_t l) const { return 2 + 3 * n_ + k * n_ + l; }
+  size_t XEXIdx_(const size_t k, const size_t l) const { return 2 + 3 * n_ + n_ * n_ + k * n_ + l; }
+
+  size_t n_;
+  std::vector<ElemT> sums_;   // N, E_L, x_k, x_k^* E_L, E_L x_k, x_k^* x_l, x_k^* E_L x_l
+};
+
+}//gqpeps
+
+#endif //GQPEPS_ALGORITHM_VMC_UPDATE_KRYLOV_SUBSPACE_SR_H
@@ -49,7 +49,8 @@ TenElemT SpinOneHalfHeisenbergSquare<TenElemT, QNT>::CalEnergyAndHoles(const SIT
       const SiteIdx site1 = {row, col};
       //Calculate the holes
       if constexpr (calchols) {
-        hole_res(site1) = Dag(tn.PunchHole(site1, HORIZONTAL));
+        tn.PunchHole(site1, HORIZONTAL, hole_res(site1));
+        hole_res(site1).Dag();
       }
       if (col < tn.cols() - 1) {
         //Calculate horizontal bond energy contribution
@@ -70,14 +71,40 @@ TenElemT SpinOneHalfHeisenbergSquare<TenElemT, QNT>::CalEnergyAndHoles(const SIT
         tn.BTenMoveStep(RIGHT);
       }
     }
+    if (this->single_orientation_ && row < tn.rows() - 1) {
+      //Calculate vertical bond energy contribution by the two-row environments
+      tn.InitBTen2(LEFT, row);
+      tn.GrowFullBTen2(RIGHT, row, 1, true);
+      // the ratios of amplitude cancel their truncation errors only against the amplitude in the same environment
+      inv_psi = 1.0 / tn.ReplaceNNSiteTraceByBTen2({row, 0}, {row + 1, 0}, tn({row, 0}), tn({row + 1, 0}));
+      for (size_t col = 0; col < tn.cols(); col++) {
+        const SiteIdx site1 = {row, col};
+        const SiteIdx site2 = {row + 1, col};
+        if (config(site1) == config(site2)) {
+          energy += 0.25;
+        } else {
+          TenElemT psi_ex = tn.ReplaceNNSiteTraceByBTen2(site1, site2,
+                                                         (*split_index_tps)(site1)[config(site2)],
+                                                         (*split_index_tps)(site2)[config(site1)]);
+          energy += (-0.25 + psi_ex * inv_psi * 0.5);
+        }
+        if (col < tn.cols() - 1) {
+          tn.BTen2MoveStep(RIGHT, row);
+        }
+      }
+    }
     if (row < tn.rows() - 1) {
       tn.BMPSMoveStep(DOWN, trunc_para);
     }
   }
+  if (this->single_orientation_) {
+    return energy;
+  }
 
   //Calculate vertical bond energy contribution
-  tn.GenerateBMPSApproach(LEFT, trunc_para);
-  for (size_t col = 0; col < tn.cols(); col++) {
+  // approach from the right to reuse the left boundary MPS, which are left complete by the Monte Carlo sweep
+  tn.GenerateBMPSApproach(RIGHT, trunc_para);
+  for (size_t col = tn.cols(); col-- > 0;) {
     tn.InitBTen(UP, col);
     tn.GrowFullBTen(DOWN, col, 2, true);
     tps_sample->amplitude = tn.Trace({0, col}, VERTICAL);
@@ -102,8 +129,8 @@ TenElemT SpinOneHalfHeisenbergSquare<TenElemT, QNT>::CalEnergyAndHoles(const SIT
         tn.BTenMoveStep(DOWN);
       }
     }
-    if (col < tn.cols() - 1) {
-      tn.BMPSMoveStep(RIGHT, trunc_para);
+    if (col > 0) {
+      tn.BMPSMoveStep(LEFT, trunc_para);
     }
   }
   return energy;
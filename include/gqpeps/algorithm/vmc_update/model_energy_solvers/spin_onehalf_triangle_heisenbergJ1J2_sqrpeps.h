@@ -13,6 +13,10 @@
 namespace gqpeps {
 using namespace gqten;
 
+/**
+ * The sqrt(5) bonds in the vertical pass span three rows, which the two-row environments cannot cover,
+ * so the single orientation evaluation (see ModelEnergySolver) is not supported and always two passes are used.
+ */
 template<typename TenElemT, typename QNT>
 class SpinOneHalfTriJ1J2HeisenbergSqrPEPS : public ModelEnergySolver<TenElemT, QNT> {
   using SITPS = SplitIndexTPS<TenElemT, QNT>;
@@ -21,6 +25,14 @@ class SpinOneHalfTriJ1J2HeisenbergSqrPEPS : public ModelEnergySolver<TenElemT, Q
 
   SpinOneHalfTriJ1J2HeisenbergSqrPEPS(double j2) : j2_(j2) {}
 
+  ///< hides ModelEnergySolver::SetSingleOrientationEvaluation, the request is ignored with a warning.
+  void SetSingleOrientationEvaluation(const bool single_orientation) {
+    if (single_orientation) {
+      std::cout << "Warning: SpinOneHalfTriJ1J2HeisenbergSqrPEPS does not support the single orientation evaluation, "
+                << "the energy is evaluated in two passes." << std::endl;
+    }
+  }
+
   template<typename WaveFunctionComponentType, bool calchols = true>
   TenElemT CalEnergyAndHoles(
       const SITPS *sitps,
@@ -53,7 +65,8 @@ CalEnergyAndHoles(const SITPS *split_index_tps,
       const SiteIdx site1 = {row, col};
       //Calculate the holes
       if constexpr (calchols) {
-        hole_res(site1) = Dag(tn.PunchHole(site1, HORIZONTAL));
+        tn.PunchHole(site1, HORIZONTAL, hole_res(site1));
+        hole_res(site1).Dag();
       }
       if (col < tn.cols() - 1) {
         //Calculate horizontal bond energy contribution
@@ -121,8 +134,9 @@ CalEnergyAndHoles(const SITPS *split_index_tps,
     }
   }
 
-  tn.GenerateBMPSApproach(LEFT, trunc_para);
-  for (size_t col = 0; col < tn.cols(); col++) {
+  // approach from the right to reuse the left boundary MPS, which are left complete by the Monte Carlo sweep
+  tn.GenerateBMPSApproach(RIGHT, trunc_para);
+  for (size_t col = tn.cols(); col-- > 0;) {
     tn.InitBTen(UP, col);
     tn.GrowFullBTen(DOWN, col, 2, true);
     tps_sample->amplitude = tn.Trace({0, col}, VERTICAL);
@@ -164,7 +178,9 @@ CalEnergyAndHoles(const SITPS *split_index_tps,
           tn.BTen2MoveStep(DOWN, col);
         }
       }
-      tn.BMPSMoveStep(RIGHT, trunc_para);
+    }
+    if (col > 0) {
+      tn.BMPSMoveStep(LEFT, trunc_para);
     }
   }
   return e1 + j2_ * e2;
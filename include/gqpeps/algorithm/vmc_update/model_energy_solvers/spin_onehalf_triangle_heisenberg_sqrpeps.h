@@ -56,7 +56,8 @@ TenElemT SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::CalEnergyAndHoles(const
       const SiteIdx site1 = {row, col};
       //Calculate the holes
       if constexpr (calchols) {
-        hole_res(site1) = Dag(tn.PunchHole(site1, HORIZONTAL));
+        tn.PunchHole(site1, HORIZONTAL, hole_res(site1));
+        hole_res(site1).Dag();
       }
       if (col < tn.cols() - 1) {
         //Calculate horizontal bond energy contribution
@@ -75,9 +76,30 @@ TenElemT SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::CalEnergyAndHoles(const
     if (row < tn.rows() - 1) {
       //calculate J2 energy
       tn.InitBTen2(LEFT, row);
-      tn.GrowFullBTen2(RIGHT, row, 2, true);
+      // the vertical bonds need the right environment of one more column
+      tn.GrowFullBTen2(RIGHT, row, this->single_orientation_ ? 1 : 2, true);
+      if (this->single_orientation_) {
+        // the ratios of amplitude cancel their truncation errors only against the amplitude in the same environment
+        inv_psi = 1.0 / tn.ReplaceNNSiteTraceByBTen2({row, 0}, {row + 1, 0}, tn({row, 0}), tn({row + 1, 0}));
+      }
 
-      for (size_t col = 0; col < tn.cols() - 1; col++) {
+      for (size_t col = 0; col < tn.cols(); col++) {
+        if (this->single_orientation_) {
+          //Calculate vertical bond energy contribution
+          const SiteIdx site1 = {row, col};
+          const SiteIdx site2 = {row + 1, col};
+          if (config(site1) == config(site2)) {
+            e += 0.25;
+          } else {
+            TenElemT psi_ex = tn.ReplaceNNSiteTraceByBTen2(site1, site2,
+                                                           (*split_index_tps)(site1)[config(site2)],
+                                                           (*split_index_tps)(site2)[config(site1)]);
+            e += (-0.25 + psi_ex * inv_psi * 0.5);
+          }
+        }
+        if (col == tn.cols() - 1) {
+          break;
+        }
         //Calculate diagonal energy contribution
         SiteIdx site1 = {row + 1, col}; //left-down
         SiteIdx site2 = {row, col + 1}; //right-up
@@ -97,9 +119,14 @@ TenElemT SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::CalEnergyAndHoles(const
     }
   }
 
+  if (this->single_orientation_) {
+    return e;
+  }
+
   //Calculate vertical bond energy contribution
-  tn.GenerateBMPSApproach(LEFT, trunc_para);
-  for (size_t col = 0; col < tn.cols(); col++) {
+  // approach from the right to reuse the left boundary MPS, which are left complete by the Monte Carlo sweep
+  tn.GenerateBMPSApproach(RIGHT, trunc_para);
+  for (size_t col = tn.cols(); col-- > 0;) {
     tn.InitBTen(UP, col);
     tn.GrowFullBTen(DOWN, col, 2, true);
     tps_sample->amplitude = tn.Trace({0, col}, VERTICAL);
@@ -119,8 +146,8 @@ TenElemT SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::CalEnergyAndHoles(const
         tn.BTenMoveStep(DOWN);
       }
     }
-    if (col < tn.cols() - 1) {
-      tn.BMPSMoveStep(RIGHT, trunc_para);
+    if (col > 0) {
+      tn.BMPSMoveStep(LEFT, trunc_para);
     }
   }
   return e;
@@ -194,8 +221,9 @@ ObservablesLocal<TenElemT> SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::Sampl
   }
 
   //Calculate vertical bond energy contribution
-  tn.GenerateBMPSApproach(LEFT, trunc_para);
-  for (size_t col = 0; col < tn.cols(); col++) {
+  // approach from the right to reuse the left boundary MPS, which are left complete by the Monte Carlo sweep
+  tn.GenerateBMPSApproach(RIGHT, trunc_para);
+  for (size_t col = tn.cols(); col-- > 0;) {
     tn.InitBTen(UP, col);
     tn.GrowFullBTen(DOWN, col, 2, true);
     tps_sample->amplitude = tn.Trace({0, col}, VERTICAL);
@@ -218,8 +246,8 @@ ObservablesLocal<TenElemT> SpinOneHalfTriHeisenbergSqrPEPS<TenElemT, QNT>::Sampl
         tn.BTenMoveStep(DOWN);
       }
     }
-    if (col < tn.cols() - 1) {
-      tn.BMPSMoveStep(RIGHT, trunc_para);
+    if (col > 0) {
+      tn.BMPSMoveStep(LEFT, trunc_para);
     }
   }
   res.energy_loc = energy_loc;
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Momentum and Adam optimizers for the TPS updates.
+*/
+
+#ifndef GQPEPS_ALGORITHM_VMC_UPDATE_MOMENTUM_OPTIMIZER_H
+#define GQPEPS_ALGORITHM_VMC_UPDATE_MOMENTUM_OPTIMIZER_H
+
+#include <vector>
+#include <cmath>
+#include <complex>
+#include "gqpeps/two_dim_tn/tps/split_index_tps.h"    //SplitIndexTPS, DataSizeSignature
+#include "gqpeps/monte_carlo_tools/statistics.h"      //DumpVecData, LoadVecData
+
+namespace gqpeps {
+using namespace gqten;
+
+/**
+ * State of the first-order optimizers with moments, which turn the gradient into the update direction:
+ *      momentum:           v = mu * v + g,                           direction = v
+ *      Nesterov momentum:  v = mu * v + g,                           direction = g + mu * v
+ *      Adam:               m = beta1 * m + (1 - beta1) * g,
+ *                          s = beta2 * s + (1 - beta2) * |g|^2,      direction = m_hat / (sqrt(s_hat) + epsilon)
+ * where m_hat and s_hat are the bias corrected moments. The step length is applied outside.
+ *
+ * The Adam moments are updated element-wise on the raw data, which assumes the gradients of all the iterations
+ * share the layout (the full blocks given by the sampling). If the layout changes, the state restarts.
+ * The state lives in the processors which apply the update.
+ */
+template<typename TenElemT, typename QNT>
+class MomentumOptimizer {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  using SITPS = SplitIndexTPS<TenElemT, QNT>;
+ public:
+  MomentumOptimizer(void) = default;
+
+  bool Empty(void) const { return step_ == 0; }
+
+  size_t Step(void) const { return step_; }
+
+  SITPS MomentumDirection(const SITPS &grad, const double mu, const bool nesterov) {
+    if (Empty() || DataSizeSignature(first_moment_) != DataSizeSignature(grad)) {
+      first_moment_ = grad;
+      step_ = 0;
+    } else {
+      first_moment_ *= TenElemT(mu);
+      first_moment_ += grad;
+    }
+    step_++;
+    if (nesterov) {
+      return grad + first_moment_ * TenElemT(mu);
+    }
+    return first_moment_;
+  }
+
+  SITPS AdamDirection(const SITPS &grad, const double beta1, const double beta2, const double epsilon) {
+    if (Empty() || second_moment_.rows() == 0 || DataSizeSignature(first_moment_) != DataSizeSignature(grad)) {
+      first_moment_ = grad * TenElemT(0);
+      second_moment_ = first_moment_;
+      step_ = 0;
+    }
+    step_++;
+    const double bias_correction1 = 1.0 - std::pow(beta1, double(step_));
+    const double bias_correction2 = 1.0 - std::pow(beta2, double(step_));
+    SITPS direction = grad;
+    for (size_t row = 0; row < grad.rows(); row++) {
+      for (size_t col = 0; col < grad.cols(); col++) {
+        for (size_t compt = 0; compt < grad({row, col}).size(); compt++) {
+          const Tensor &g_ten = grad({row, col})[compt];
+          if (g_ten.IsDefault()) {
+            continue;
+          }
+          // the raw data are owned by the tensors, update them directly.
+          const TenElemT *g = g_ten.GetRawDataPtr();
+          TenElemT *m = const_cast<TenElemT *>(first_moment_({row, col})[compt].GetRawDataPtr());
+          TenElemT *s = const_cast<TenElemT *>(second_moment_({row, col})[compt].GetRawDataPtr());
+          TenElemT *d = const_cast<TenElemT *>(direction({row, col})[compt].GetRawDataPtr());
+          for (size_t i = 0; i < g_ten.GetActualDataSize(); i++) {
+            m[i] = beta1 * m[i] + (1.0 - beta1) * g[i];
+            s[i] = beta2 * std::real(s[i]) + (1.0 - beta2) * std::norm(g[i]);
+            d[i] = (m[i] * (1.0 / bias_correction1)) / (std::sqrt(std::real(s[i]) / bias_correction2) + epsilon);
+          }
+        }
+      }
+    }
+    return direction;
+  }
+
+  void Dump(const std::string &path) {
+    if (!gqmps2::IsPathExist(path)) { gqmps2::CreatPath(path); }
+    first_moment_.Dump(path + "/first_moment");
+    if (second_moment_.rows() > 0) {
+      second_moment_.Dump(path + "/second_moment");
+    }
+    DumpVecData(path + "/optimizer_step", std::vector<size_t>{step_});
+  }
+
+  ///< return false if there is no state in the path, in which case the state is cleared.
+  bool Load(const std::string &path, const size_t rows, const size_t cols) {
+    std::vector<size_t> step;
+    first_moment_ = SITPS(rows, cols);
+    second_moment_ = SITPS(rows, cols);
+    if (!LoadVecData(path + "/optimizer_step", step) || step.size() != 1
+        || !first_moment_.Load(path + "/first_moment")) {
+      *this = MomentumOptimizer();
+      return false;
+    }
+    step_ = step[0];
+    if (!gqmps2::IsPathExist(path + "/second_moment") || !second_moment_.Load(path + "/second_moment")) {
+      second_moment_ = SITPS();
+    }
+    return true;
+  }
+
+ private:
+  SITPS first_moment_;    // velocity of momentum, or the first moment of Adam
+  SITPS second_moment_;   // Adam only, the real parts store the moments
+  size_t step_ = 0;       // the number of the updates, for the bias correction of Adam
+};
+
+}//gqpeps
+
+#endif //GQPEPS_ALGORITHM_VMC_UPDATE_MOMENTUM_OPTIMIZER_H
@@ -16,6 +16,8 @@
 #include "gqpeps/algorithm/vmc_update/vmc_optimize_para.h"  //VMCOptimizePara
 #include "gqpeps/algorithm/vmc_update/model_measurement_solver.h" //ObservablesLocal
 #include "gqpeps/monte_carlo_tools/statistics.h"    // Mean, Variance, DumpVecData, ...
+#include "gqpeps/monte_carlo_tools/random_stream.h" // RandomStream
+#include "gqpeps/utility/preemption.h"              // WalltimeBudget, TrapPreemptionSignals
 
 namespace gqpeps {
 using namespace gqten;
@@ -158,17 +160,23 @@ class MonteCarloMeasurementExecutor : public Executor {
   VMCOptimizePara optimize_para;
 
  private:
+  struct MarkovChain;
+
   void ReserveSamplesDataSpace_();
 
   void PrintExecutorInfo_(void);
 
   void Measure_(void);
 
-  std::vector<double> MCSweep_(void);
+  void InitRandomSeed_(void);
+
+  void InitChains_(const Configuration &config);
+
+  std::vector<double> MCSweep_(MarkovChain &chain);
 
   void WarmUp_(void);
 
-  void MeasureSample_(void);
+  void MeasureSample_(MarkovChain &chain);
 
   void GatherStatistic_(void);
 
@@ -181,13 +189,9 @@ class MonteCarloMeasurementExecutor : public Executor {
 
   SITPST split_index_tps_;
 
-  WaveFunctionComponentType tps_sample_;
-
-  std::uniform_real_distribution<double> u_double_;
-
   bool warm_up_;
 
-  MeasurementSolver measurement_solver_;
+  MeasurementSolver measurement_solver_; // copied into each chain
   struct Result {
     TenElemT energy;
     TenElemT en_err;
@@ -270,7 +274,23 @@ class MonteCarloMeasurementExecutor : public Executor {
       res_thread.one_point_functions_auto_corr = CalSpinAutoCorrelation(one_point_function_samples);
       return res_thread;
     }
-  } sample_data_;
+  } sample_data_; // samples of all the chains, in the order of the chains
+
+  ///< runtime data of one Markov chain. The chains in one processor are sampled in parallel threads.
+  struct MarkovChain {
+    WaveFunctionComponentType tps_sample;
+    MeasurementSolver measurement_solver;
+    RandomStream rand_stream;
+    SampleData sample_data;
+    std::vector<double> accept_rates_accum;
+
+    MarkovChain(const size_t ly, const size_t lx, const MeasurementSolver &solver) :
+        tps_sample(ly, lx), measurement_solver(solver) {}
+  };
+
+  std::vector<MarkovChain> chains_;
+  uint64_t random_seed_; // same in all the processors
+  WalltimeBudget walltime_;
   // the lattice site number = Lx * Ly * 3,  first the unit cell, then column idx, then row index.
 };//MonteCarloMeasurementExecutor
 
@@ -280,10 +300,9 @@ void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, Mea
   SynchronizeConfiguration_();
   std::vector<double> overlaps;
   overlaps.reserve(optimize_para.mc_samples);
-//  std::cout << "Random number from worker " << world_.rank() << " : " << u_double_(random_engine) << std::endl;
   std::vector<double> accept_rates_accum;
   for (size_t sweep = 0; sweep < optimize_para.mc_samples; sweep++) {
-    std::vector<double> accept_rates = MCSweep_();
+    std::vector<double> accept_rates = MCSweep_(chains_[0]);
     if (sweep == 0) {
       accept_rates_accum = accept_rates;
     } else {
@@ -296,11 +315,12 @@ void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, Mea
     size_t dest = (world_.rank() + 1) % world_.size();
     size_t source = (world_.rank() + world_.size() - 1) % world_.size();
     MPI_Status status;
-    int err_msg = MPI_Sendrecv(tps_sample_.config, dest, dest, config2, source, world_.rank(), MPI_Comm(world_),
-                               &status);
+    int err_msg = MPI_Sendrecv(chains_[0].tps_sample.config, dest, dest, config2, source, world_.rank(),
+                               MPI_Comm(world_), &status);
 
     // calculate overlap
-    double overlap = SpinConfigurationOverlap2(KagomeConfig2Sz(tps_sample_.config), KagomeConfig2Sz(config2));
+    double overlap = SpinConfigurationOverlap2(KagomeConfig2Sz(chains_[0].tps_sample.config),
+                                               KagomeConfig2Sz(config2));
     overlaps.push_back(overlap);
     if (world_.rank() == kMasterProc && (sweep + 1) % (optimize_para.mc_samples / 10) == 0) {
       PrintProgressBar((sweep + 1), optimize_para.mc_samples);
@@ -324,7 +344,7 @@ void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, Mea
     }
   world_.barrier();
   DumpVecData(replica_overlap_path + "/replica_overlap" + std::to_string(world_.rank()), overlaps);
-  tps_sample_.config.Dump(optimize_para.wavefunction_path, world_.rank());
+  chains_[0].tps_sample.config.Dump(optimize_para.wavefunction_path, world_.rank());
 }
 
 template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
@@ -334,12 +354,49 @@ void MonteCarloMeasurementExecutor<TenElemT,
                                    MeasurementSolver>::ReserveSamplesDataSpace_(
     void) {
   sample_data_.Reserve(optimize_para.mc_samples);
+  for (MarkovChain &chain : chains_) {
+    chain.sample_data.Reserve(optimize_para.mc_samples / chains_.size() + 1);
+  }
 }
 
 template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
-void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::MeasureSample_() {
-  ObservablesLocal<TenElemT> observables_local = measurement_solver_.SampleMeasure(&split_index_tps_, &tps_sample_);
-  sample_data_.PushBack(std::move(observables_local));
+void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::MeasureSample_(
+    MarkovChain &chain) {
+  ObservablesLocal<TenElemT> observables_local = chain.measurement_solver.SampleMeasure(&split_index_tps_,
+                                                                                        &chain.tps_sample);
+  chain.sample_data.PushBack(std::move(observables_local));
+}
+
+///< the seed is drawn by master if not given
+template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
+void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::InitRandomSeed_(void) {
+  random_seed_ = optimize_para.random_seed;
+  if (random_seed_ == 0) {
+    if (world_.rank() == kMasterProc) {
+      random_seed_ = RandomDeviceSeed();
+    }
+    boost::mpi::broadcast(world_, random_seed_, kMasterProc);
+  }
+}
+
+/**
+ * Create the Markov chains in this processor from the configuration, and seed their random streams.
+ * The chains start from the same configuration and are decorrelated by the warm up.
+ */
+template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
+void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::InitChains_(
+    const Configuration &config) {
+  const size_t chain_num = std::max<size_t>(1, optimize_para.chains_per_proc);
+  chains_.clear();
+  chains_.reserve(chain_num);
+  for (size_t c = 0; c < chain_num; c++) {
+    chains_.emplace_back(ly_, lx_, measurement_solver_);
+    chains_[c].rand_stream.Seed(random_seed_, world_.rank(), c);
+  }
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+  for (size_t c = 0; c < chain_num; c++) {
+    chains_[c].tps_sample = WaveFunctionComponentType(split_index_tps_, config);
+  }
 }
 
 template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
@@ -370,8 +427,20 @@ MonteCarloMeasurementExecutor<TenElemT,
                               QNT,
                               WaveFunctionComponentType,
                               MeasurementSolver>::DumpData(const std::string &tps_path) {
-
-  tps_sample_.config.Dump(tps_path, world_.rank());
+  if (world_.rank() == kMasterProc) {
+    for (size_t c = 1; c < chains_.size(); c++) {
+      if (!IsPathExist(ChainConfigurationPath(tps_path, c))) {
+        CreatPath(ChainConfigurationPath(tps_path, c));
+      }
+    }
+  }
+  world_.barrier();
+  chains_[0].tps_sample.config.Dump(tps_path, world_.rank());
+  chains_[0].rand_stream.Dump(tps_path, world_.rank());
+  for (size_t c = 1; c < chains_.size(); c++) {
+    chains_[c].tps_sample.config.Dump(ChainConfigurationPath(tps_path, c), world_.rank());
+    chains_[c].rand_stream.Dump(ChainConfigurationPath(tps_path, c), world_.rank());
+  }
 
   std::string energy_raw_path = "energy_raw_data/";
   if (world_.rank() == kMasterProc && !IsPathExist(energy_raw_path))
@@ -394,11 +463,14 @@ MonteCarloMeasurementExecutor<TenElemT,
     const boost::mpi::communicator &world,
     const MeasurementSolver &solver):
     optimize_para(optimize_para), world_(world), lx_(lx), ly_(ly),
-    split_index_tps_(ly, lx), tps_sample_(ly, lx),
-    u_double_(0, 1), warm_up_(false),
+    split_index_tps_(ly, lx), warm_up_(false),
     measurement_solver_(solver) {
   WaveFunctionComponentType::trun_para = BMPSTruncatePara(optimize_para);
-  random_engine.seed(std::random_device{}() + world.rank() * 10086);
+  walltime_ = WalltimeBudget(optimize_para.walltime_budget);
+  if (optimize_para.trap_preemption_signals) {
+    TrapPreemptionSignals();
+  }
+  InitRandomSeed_();
   LoadTenData();
   ReserveSamplesDataSpace_();
   PrintExecutorInfo_();
@@ -418,12 +490,15 @@ MonteCarloMeasurementExecutor<TenElemT,
     lx_(sitpst_init.cols()),
     ly_(sitpst_init.rows()),
     split_index_tps_(sitpst_init),
-    tps_sample_(ly_, lx_),
-    u_double_(0, 1), warm_up_(false),
+    warm_up_(false),
     measurement_solver_(solver) {
   WaveFunctionComponentType::trun_para = BMPSTruncatePara(optimize_para);
-  random_engine.seed(std::random_device{}() + world.rank() * 10086);
-  tps_sample_ = WaveFunctionComponentType(sitpst_init, optimize_para.init_config);
+  walltime_ = WalltimeBudget(optimize_para.walltime_budget);
+  if (optimize_para.trap_preemption_signals) {
+    TrapPreemptionSignals();
+  }
+  InitRandomSeed_();
+  InitChains_(optimize_para.init_config);
   ReserveSamplesDataSpace_();
   PrintExecutorInfo_();
   this->SetStatus(ExecutorStatus::INITED);
@@ -448,6 +523,7 @@ void MonteCarloMeasurementExecutor<TenElemT,
     std::cout << std::setw(40) << "The number of processors (including master):" << world_.size() << "\n";
     std::cout << std::setw(40) << "The number of threads per processor:" << hp_numeric::GetTensorManipulationThreads()
               << "\n";
+    std::cout << std::setw(40) << "Random seed:" << random_seed_ << "\n";
   }
 }
 
@@ -463,8 +539,11 @@ template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, ty
 void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::WarmUp_(void) {
   if (!warm_up_) {
     Timer warm_up_timer("warm_up");
-    for (size_t sweep = 0; sweep < optimize_para.mc_warm_up_sweeps; sweep++) {
-      auto accept_rates = MCSweep_();
+#pragma omp parallel for num_threads(chains_.size()) schedule(static, 1) if(chains_.size() > 1)
+    for (size_t c = 0; c < chains_.size(); c++) {
+      for (size_t sweep = 0; sweep < optimize_para.mc_warm_up_sweeps; sweep++) {
+        auto accept_rates = MCSweep_(chains_[c]);
+      }
     }
     double elasp_time = warm_up_timer.Elapsed();
     std::cout << "Proc " << std::setw(4) << world_.rank() << " warm-up completes T = " << elasp_time << "s."
@@ -479,10 +558,10 @@ void MonteCarloMeasurementExecutor<TenElemT,
                                    WaveFunctionComponentType,
                                    MeasurementSolver>::SynchronizeConfiguration_(
     const size_t root) {
-  Configuration config(tps_sample_.config);
+  Configuration config(chains_[0].tps_sample.config);
   MPI_BCast(config, root, MPI_Comm(world_));
   if (world_.rank() != root) {
-    tps_sample_ = WaveFunctionComponentType(split_index_tps_, config);
+    chains_[0].tps_sample = WaveFunctionComponentType(split_index_tps_, config);
   }
 }
 
@@ -502,13 +581,30 @@ void MonteCarloMeasurementExecutor<TenElemT,
   }
   Configuration config(ly_, lx_);
   bool load_config = config.Load(tps_path, world_.rank());
-  if (load_config) {
-    tps_sample_ = WaveFunctionComponentType(split_index_tps_, config);
-  } else {
+  if (!load_config) {
     std::cout << "Loading configuration in rank " << world_.rank()
               << " fails. Random generate it and warm up."
               << std::endl;
-    tps_sample_ = WaveFunctionComponentType(split_index_tps_, optimize_para.init_config);
+    config = optimize_para.init_config;
+  }
+  InitChains_(config);
+  // continue the streams of the last run if they are dumped
+  chains_[0].rand_stream.Load(tps_path, world_.rank());
+  for (size_t c = 1; c < chains_.size(); c++) {
+    chains_[c].rand_stream.Load(ChainConfigurationPath(tps_path, c), world_.rank());
+    Configuration chain_config(ly_, lx_);
+    if (chain_config.Load(ChainConfigurationPath(tps_path, c), world_.rank())) {
+      chains_[c].tps_sample = WaveFunctionComponentType(split_index_tps_, chain_config);
+    } else {
+      if (load_config) {
+        std::cout << "Loading configuration of chain " << c << " in rank " << world_.rank()
+                  << " fails. Warm up from the configuration of chain 0."
+                  << std::endl;
+      }
+      load_config = false;
+    }
+  }
+  if (!load_config) {
     WarmUp_();
   }
   warm_up_ = true;
@@ -521,24 +617,64 @@ void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, Mea
 
 template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, typename MeasurementSolver>
 void MonteCarloMeasurementExecutor<TenElemT, QNT, WaveFunctionComponentType, MeasurementSolver>::Measure_(void) {
-  std::vector<double> accept_rates_accum;
-  for (size_t sweep = 0; sweep < optimize_para.mc_samples; sweep++) {
-    std::vector<double> accept_rates = MCSweep_();
-    if (sweep == 0) {
-      accept_rates_accum = accept_rates;
-    } else {
-      for (size_t i = 0; i < accept_rates_accum.size(); i++) {
-        accept_rates_accum[i] += accept_rates[i];
+  const size_t chain_num = chains_.size();
+  const size_t sample_num = optimize_para.mc_samples;
+  std::vector<size_t> chain_sample_done(chain_num, 0);
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+  for (size_t c = 0; c < chain_num; c++) {
+    MarkovChain &chain = chains_[c];
+    const size_t chain_sample_num = sample_num / chain_num + (c < sample_num % chain_num ? 1 : 0);
+    double sample_time = 0.0;
+    for (size_t sweep = 0; sweep < chain_sample_num; sweep++) {
+      // stop early, but keep at least one sample, if the job is going to be killed
+      if (sweep > 0 && (PreemptionSignalReceived() || walltime_.Remaining() < 1.5 * sample_time)) {
+        break;
       }
+      const auto sample_start = std::chrono::steady_clock::now();
+      std::vector<double> accept_rates = MCSweep_(chain);
+      if (sweep == 0) {
+        chain.accept_rates_accum = accept_rates;
+      } else {
+        for (size_t i = 0; i < chain.accept_rates_accum.size(); i++) {
+          chain.accept_rates_accum[i] += accept_rates[i];
+        }
+      }
+      MeasureSample_(chain);
+      if (c == 0 && world_.rank() == kMasterProc && chain_sample_num >= 10
+          && (sweep + 1) % (chain_sample_num / 10) == 0) {
+        PrintProgressBar((sweep + 1), chain_sample_num);
+      }
+      sample_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - sample_start).count();
+      chain_sample_done[c] = sweep + 1;
     }
-    MeasureSample_();
-    if (world_.rank() == kMasterProc && (sweep + 1) % (optimize_para.mc_samples / 10) == 0) {
-      PrintProgressBar((sweep + 1), optimize_para.mc_samples);
+  }
+  size_t sample_done = 0;
+  for (size_t done : chain_sample_done) {
+    sample_done += done;
+  }
+  if (sample_done < sample_num) {
+    std::cout << "Proc " << std::setw(4) << world_.rank() << " stops the sampling after " << sample_done
+              << " samples because of the preemption signal or the walltime budget." << std::endl;
+  }
+  std::vector<double> accept_rates_avg;
+  for (MarkovChain &chain : chains_) {
+    SampleData &data = chain.sample_data;
+    for (size_t i = 0; i < data.energy_samples.size(); i++) {
+      sample_data_.energy_samples.push_back(data.energy_samples[i]);
+      sample_data_.bond_energy_samples.push_back(std::move(data.bond_energy_samples[i]));
+      sample_data_.one_point_function_samples.push_back(std::move(data.one_point_function_samples[i]));
+      sample_data_.two_point_function_samples.push_back(std::move(data.two_point_function_samples[i]));
+    }
+    data = SampleData();
+    if (accept_rates_avg.empty()) {
+      accept_rates_avg.assign(chain.accept_rates_accum.size(), 0.0);
+    }
+    for (size_t i = 0; i < chain.accept_rates_accum.size(); i++) {
+      accept_rates_avg[i] += chain.accept_rates_accum[i];
     }
   }
-  std::vector<double> accept_rates_avg = accept_rates_accum;
   for (double &rates : accept_rates_avg) {
-    rates /= double(optimize_para.mc_samples);
+    rates /= double(sample_done);
   }
   std::cout << "Accept rate = [";
   for (double &rate : accept_rates_avg) {
@@ -552,10 +688,10 @@ template<typename TenElemT, typename QNT, typename WaveFunctionComponentType, ty
 std::vector<double> MonteCarloMeasurementExecutor<TenElemT,
                                                   QNT,
                                                   WaveFunctionComponentType,
-                                                  MeasurementSolver>::MCSweep_(void) {
+                                                  MeasurementSolver>::MCSweep_(MarkovChain &chain) {
   std::vector<double> accept_rates;
   for (size_t i = 0; i < optimize_para.mc_sweeps_between_sample; i++) {
-    tps_sample_.MonteCarloSweepUpdate(split_index_tps_, unit_even_distribution, accept_rates);
+    chain.tps_sample.MonteCarloSweepUpdate(split_index_tps_, chain.rand_stream, accept_rates);
   }
   return accept_rates;
 }
@@ -0,0 +1,322 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Packed dense storage of the O^*(S) samples used in stochastic reconfiguration.
+*/
+
+#ifndef GQPEPS_ALGORITHM_VMC_UPDATE_PACKED_O_MATRIX_H
+#define GQPEPS_ALGORITHM_VMC_UPDATE_PACKED_O_MATRIX_H
+
+#include <vector>
+#include <complex>
+#include "gqpeps/two_dim_tn/tps/split_index_tps.h"    //SplitIndexTPS
+#include "gqpeps/utility/conjugate_elem.h"            //ConjugateElem
+#include "gqpeps/utility/mpi_type.h"                  //MPIDataType
+
+namespace gqpeps {
+using namespace gqten;
+
+/**
+ * O^*(S) samples stored in a samples x row_size row-major block.
+ *
+ * For one sample, only the component of each site corresponding to the sampled configuration is nonzero.
+ * So each row only stores the active components, with the site offsets site_offset_.
+ * The positions of the components in the flattened parameter vector (all the sites and components of a
+ * SplitIndexTPS with full blocks) are given by the offset table param_offset_.
+ *
+ * The layout (a SplitIndexTPS with zero tensors with full blocks) should be the same in all the processors.
+ */
+template<typename TenElemT, typename QNT>
+class PackedOMatrix {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  using SITPS = SplitIndexTPS<TenElemT, QNT>;
+ public:
+  PackedOMatrix(void) = default;
+
+  /**
+   * Build the offset tables and clear the samples.
+   * @param layout  zero tensors with full blocks
+   * @param sample_num_reserve  expected number of samples
+   */
+  void Initialize(const SITPS &layout, const size_t sample_num_reserve) {
+    layout_ = layout;
+    rows_ = layout.rows();
+    cols_ = layout.cols();
+    const size_t site_num = rows_ * cols_;
+    site_offset_.assign(site_num, 0);
+    param_offset_.assign(site_num, std::vector<size_t>());
+    compt_size_.assign(site_num, std::vector<size_t>());
+    row_size_ = 0;
+    param_size_ = 0;
+    for (size_t row = 0; row < rows_; row++) {
+      for (size_t col = 0; col < cols_; col++) {
+        const size_t site = row * cols_ + col;
+        site_offset_[site] = row_size_;
+        size_t max_size = 0;
+        for (const Tensor &ten : layout_({row, col})) {
+          const size_t size = ten.IsDefault() ? 0 : ten.GetActualDataSize();
+          param_offset_[site].push_back(param_size_);
+          compt_size_[site].push_back(size);
+          param_size_ += size;
+          max_size = std::max(max_size, size);
+        }
+        row_size_ += max_size;
+      }
+    }
+    Clear();
+    data_.reserve(sample_num_reserve * row_size_);
+    configs_.reserve(sample_num_reserve * site_num);
+  }
+
+  void Clear(void) {
+    data_.clear();
+    configs_.clear();
+    sample_num_ = 0;
+  }
+
+  size_t SampleNum(void) const { return sample_num_; }
+
+  size_t ParamSize(void) const { return param_size_; }
+
+  size_t SiteNum(void) const { return rows_ * cols_; }
+
+  size_t ComponentNum(const size_t site) const { return compt_size_[site].size(); }
+
+  ///< offset of the site component in the parameter vector, sites are indexed by row * cols + col
+  size_t ComponentOffset(const size_t site, const size_t compt) const { return param_offset_[site][compt]; }
+
+  size_t ComponentSize(const size_t site, const size_t compt) const { return compt_size_[site][compt]; }
+
+  ///< append a new sample (row) and return its index
+  size_t AppendSample(void) {
+    data_.resize(data_.size() + row_size_, TenElemT(0));
+    configs_.resize(configs_.size() + rows_ * cols_, 0);
+    return sample_num_++;
+  }
+
+  ///< set the O^*(S) tensor of the site, whose component is given by the configuration on this site.
+  void SetSiteData(const size_t sample, const SiteIdx &site, const size_t compt, const Tensor &gten) {
+    const size_t site_idx = site[0] * cols_ + site[1];
+    configs_[sample * rows_ * cols_ + site_idx] = compt;
+    CopyToFullBlocks_(gten, site, compt, data_.data() + sample * row_size_ + site_offset_[site_idx]);
+  }
+
+  ///< flatten the SplitIndexTPS into the parameter vector
+  void Flatten(const SITPS &v, std::vector<TenElemT> &v_flat) const {
+    v_flat.assign(param_size_, TenElemT(0));
+    for (size_t row = 0; row < rows_; row++) {
+      for (size_t col = 0; col < cols_; col++) {
+        const size_t site = row * cols_ + col;
+        for (size_t compt = 0; compt < compt_size_[site].size(); compt++) {
+          const Tensor &ten = v({row, col})[compt];
+          if (!ten.IsDefault()) {
+            CopyToFullBlocks_(ten, {row, col}, compt, v_flat.data() + param_offset_[site][compt]);
+          }
+        }
+      }
+    }
+  }
+
+  ///< inverse of Flatten
+  SITPS Unflatten(const std::vector<TenElemT> &v_flat) const {
+    SITPS res = layout_;
+    for (size_t row = 0; row < rows_; row++) {
+      for (size_t col = 0; col < cols_; col++) {
+        const size_t site = row * cols_ + col;
+        for (size_t compt = 0; compt < compt_size_[site].size(); compt++) {
+          if (compt_size_[site][compt] == 0) {
+            continue;
+          }
+          // the raw data are owned by the tensor, write the data directly.
+          TenElemT *data = const_cast<TenElemT *>(res({row, col})[compt].GetRawDataPtr());
+          std::copy(v_flat.data() + param_offset_[site][compt],
+                    v_flat.data() + param_offset_[site][compt] + compt_size_[site][compt],
+                    data);
+        }
+      }
+    }
+    return res;
+  }
+
+  /**
+   * res = O^T * (O^* * v), where the i-th row of O is the sample O^*(S_i).
+   * In terms of SplitIndexTPS, res = sum_i O_i (O_i^dag * v).
+   */
+  void MultiplyOOdag(const std::vector<TenElemT> &v_flat, std::vector<TenElemT> &res_flat) const {
+    std::vector<TenElemT> ov;
+    ConjMultiply(v_flat, ov);
+    TransMultiply(ov, res_flat);
+  }
+
+  ///< ov_i = O_i^dag * v, parallelized by OpenMP over samples
+  void ConjMultiply(const std::vector<TenElemT> &v_flat, std::vector<TenElemT> &ov) const {
+    const size_t site_num = rows_ * cols_;
+    ov.assign(sample_num_, TenElemT(0));
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(static)
+    for (size_t sample = 0; sample < sample_num_; sample++) {
+      const TenElemT *row_data = data_.data() + sample * row_size_;
+      const size_t *config = configs_.data() + sample * site_num;
+      TenElemT sum(0);
+      for (size_t site = 0; site < site_num; site++) {
+        const size_t compt = config[site];
+        const TenElemT *o = row_data + site_offset_[site];
+        const TenElemT *v = v_flat.data() + param_offset_[site][compt];
+        for (size_t i = 0; i < compt_size_[site][compt]; i++) {
+          sum += ConjugateElem(o[i]) * v[i];
+        }
+      }
+      ov[sample] = sum;
+    }
+  }
+
+  ///< res = sum_i coefs_i O_i, parallelized by OpenMP over sites
+  void TransMultiply(const std::vector<TenElemT> &coefs, std::vector<TenElemT> &res_flat) const {
+    const size_t site_num = rows_ * cols_;
+    res_flat.assign(param_size_, TenElemT(0));
+    // different sites write to different parts of res_flat
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(dynamic)
+    for (size_t site = 0; site < site_num; site++) {
+      for (size_t sample = 0; sample < sample_num_; sample++) {
+        const size_t compt = configs_[sample * site_num + site];
+        const TenElemT *o = data_.data() + sample * row_size_ + site_offset_[site];
+        TenElemT *r = res_flat.data() + param_offset_[site][compt];
+        const TenElemT coef = coefs[sample];
+        for (size_t i = 0; i < compt_size_[site][compt]; i++) {
+          r[i] += coef * o[i];
+        }
+      }
+    }
+  }
+
+  ///< diag_k += sum_i |O_ik|^2, the diagonal of O^T O^* in the flattened parameter vector.
+  void AccumulateSquareDiagonal(std::vector<double> &diag) const {
+    const size_t site_num = rows_ * cols_;
+    assert(diag.size() == param_size_);
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(dynamic)
+    for (size_t site = 0; site < site_num; site++) {
+      for (size_t sample = 0; sample < sample_num_; sample++) {
+        const size_t compt = configs_[sample * site_num + site];
+        const TenElemT *o = data_.data() + sample * row_size_ + site_offset_[site];
+        double *d = diag.data() + param_offset_[site][compt];
+        for (size_t i = 0; i < compt_size_[site][compt]; i++) {
+          d[i] += std::norm(o[i]);
+        }
+      }
+    }
+  }
+
+  /**
+   * block_kl += sum_i O_ik O_il^*, for k, l in the component compt of the site.
+   * Only the samples with the configuration compt on the site contribute.
+   *
+   * @param block  row-major, ComponentSize(site, compt)^2 elements
+   */
+  void AccumulateComponentBlock(const size_t site, const size_t compt, TenElemT *block) const {
+    const size_t site_num = rows_ * cols_;
+    const size_t n = compt_size_[site][compt];
+    for (size_t sample = 0; sample < sample_num_; sample++) {
+      if (configs_[sample * site_num + site] != compt) {
+        continue;
+      }
+      const TenElemT *o = data_.data() + sample * row_size_ + site_offset_[site];
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(static)
+      for (size_t k = 0; k < n; k++) {
+        for (size_t l = 0; l < n; l++) {
+          block[k * n + l] += o[k] * ConjugateElem(o[l]);
+        }
+      }
+    }
+  }
+
+  /**
+   * The Gram matrix G_ij = O_i^dag * O_j of the samples in all the processors.
+   * The samples in processor r are indexed by r * SampleNum() + i. The sample numbers in all the processors
+   * should be the same. The blocks of samples are passed around the processors in a ring,
+   * so only two blocks are kept in memory at the same time.
+   *
+   * @param gram  output, total_num x total_num row-major, available in all the processors.
+   */
+  void GramMatrix(const boost::mpi::communicator &world, std::vector<TenElemT> &gram) const {
+    const size_t site_num = rows_ * cols_;
+    const size_t world_size = world.size(), rank = world.rank();
+    const size_t total_num = sample_num_ * world_size;
+    MPI_Datatype data_type = MPIDataType<TenElemT>();
+    gram.assign(total_num * total_num, TenElemT(0));
+    std::vector<TenElemT> block_data(data_);
+    std::vector<size_t> block_configs(configs_);
+    for (size_t step = 0; step < world_size; step++) {
+      const size_t block_rank = (rank + world_size - step) % world_size;
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(static)
+      for (size_t i = 0; i < sample_num_; i++) {
+        for (size_t j = 0; j < sample_num_; j++) {
+          gram[(rank * sample_num_ + i) * total_num + block_rank * sample_num_ + j] =
+              RowInnerProduct_(data_.data() + i * row_size_, configs_.data() + i * site_num,
+                               block_data.data() + j * row_size_, block_configs.data() + j * site_num);
+        }
+      }
+      if (step + 1 < world_size) {
+        const int dest = (rank + 1) % world_size, src = (rank + world_size - 1) % world_size;
+        ::MPI_Sendrecv_replace(block_data.data(), block_data.size(), data_type, dest, 2 * step,
+                               src, 2 * step, MPI_Comm(world), MPI_STATUS_IGNORE);
+        ::MPI_Sendrecv_replace(block_configs.data(), block_configs.size(), MPI_UNSIGNED_LONG_LONG, dest, 2 * step + 1,
+                               src, 2 * step + 1, MPI_Comm(world), MPI_STATUS_IGNORE);
+      }
+    }
+    ::MPI_Allreduce(MPI_IN_PLACE, gram.data(), gram.size(), data_type, MPI_SUM, MPI_Comm(world));
+  }
+
+ private:
+  ///< O_i^dag * O_j of two packed rows, only the sites with the same component contribute.
+  TenElemT RowInnerProduct_(const TenElemT *row_i, const size_t *config_i,
+                            const TenElemT *row_j, const size_t *config_j) const {
+    TenElemT sum(0);
+    for (size_t site = 0; site < rows_ * cols_; site++) {
+      if (config_i[site] != config_j[site]) {
+        continue;
+      }
+      const TenElemT *oi = row_i + site_offset_[site];
+      const TenElemT *oj = row_j + site_offset_[site];
+      for (size_t k = 0; k < compt_size_[site][config_i[site]]; k++) {
+        sum += ConjugateElem(oi[k]) * oj[k];
+      }
+    }
+    return sum;
+  }
+
+  /**
+   * Copy the raw data of ten into dest, in the layout of the tensor with full blocks.
+   * The blocks of ten are a subset of the full blocks, so the same data size means the same block structure.
+   * Otherwise, the tensor is added to the full block zero tensor to fill the absent blocks.
+   */
+  void CopyToFullBlocks_(const Tensor &ten, const SiteIdx &site, const size_t compt, TenElemT *dest) const {
+    const size_t size = compt_size_[site[0] * cols_ + site[1]][compt];
+    if (ten.GetActualDataSize() == size) {
+      const TenElemT *data = ten.GetRawDataPtr();
+      std::copy(data, data + size, dest);
+    } else {
+      Tensor full = layout_(site)[compt];
+      full += ten;
+      const TenElemT *data = full.GetRawDataPtr();
+      std::copy(data, data + size, dest);
+    }
+  }
+
+  SITPS layout_;
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  size_t row_size_ = 0;
+  size_t param_size_ = 0;
+  size_t sample_num_ = 0;
+  std::vector<size_t> site_offset_;                 // offset of the site in one row
+  std::vector<std::vector<size_t>> param_offset_;   // offset of the site component in the parameter vector
+  std::vector<std::vector<size_t>> compt_size_;     // data size of the site component
+  std::vector<TenElemT> data_;                      // samples x row_size_, row-major
+  std::vector<size_t> configs_;                     // samples x sites, the active components
+};
+
+}//gqpeps
+
+#endif //GQPEPS_ALGORITHM_VMC_UPDATE_PACKED_O_MATRIX_H
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Step length controller by the energy feedback.
+*/
+
+#ifndef GQPEPS_ALGORITHM_VMC_UPDATE_STEP_LENGTH_CONTROLLER_H
+#define GQPEPS_ALGORITHM_VMC_UPDATE_STEP_LENGTH_CONTROLLER_H
+
+#include <cmath>
+#include <algorithm>
+#include "gqpeps/monte_carlo_tools/statistics.h"      //DumpVecData, LoadVecData
+
+namespace gqpeps {
+
+/**
+ * Trust region like controller of the step length, fed by the energy, its error bar and the gradient norm
+ * measured at the TPS of every iteration.
+ *
+ * - If the energy increases beyond reject_sigma error bars compared with the last accepted TPS,
+ *   the last update should be rejected, and the step length shrinks.
+ * - If the energy and the gradient norm both decrease for two iterations in a row, the step length grows.
+ * - Otherwise the step length is kept.
+ */
+class StepLengthController {
+ public:
+  StepLengthController(const double grow = 1.2, const double shrink = 0.5,
+                       const double min_step = 0.0, const double max_step = 0.0,
+                       const double reject_sigma = 2.0) :
+      grow_(grow), shrink_(shrink), min_step_(min_step), max_step_(max_step), reject_sigma_(reject_sigma) {}
+
+  /**
+   * @param energy, energy_err, grad_norm  measured at the current TPS
+   * @param has_last_update  whether the current TPS is given by an update which can be rejected
+   * @param step_len  input the current step length, output the step length for this iteration
+   * @return true if the last update should be rejected
+   */
+  bool Feed(const double energy, const double energy_err, const double grad_norm, const bool has_last_update,
+            double &step_len) {
+    if (!has_reference_) {
+      SetReference_(energy, energy_err, grad_norm);
+      return false;
+    }
+    const double sigma = std::sqrt(energy_err * energy_err + ref_energy_err_ * ref_energy_err_);
+    if (has_last_update && energy > ref_energy_ + reject_sigma_ * sigma) {
+      step_len = Clamp_(step_len * shrink_);
+      success_num_ = 0;
+      return true;
+    }
+    if (energy < ref_energy_ && grad_norm < ref_grad_norm_) {
+      success_num_++;
+    } else {
+      success_num_ = 0;
+    }
+    if (success_num_ >= 2) {
+      step_len = Clamp_(step_len * grow_);
+    }
+    SetReference_(energy, energy_err, grad_norm);
+    return false;
+  }
+
+  ///< dump the reference state into the file, the parameters are not dumped.
+  void Dump(const std::string &filename) const {
+    DumpVecData(filename, std::vector<double>{double(has_reference_), ref_energy_, ref_energy_err_, ref_grad_norm_,
+                                              double(success_num_)});
+  }
+
+  ///< load the reference state written by Dump, return false and keep the state if fails.
+  bool Load(const std::string &filename) {
+    std::vector<double> state;
+    if (!LoadVecData(filename, state) || state.size() != 5) {
+      return false;
+    }
+    has_reference_ = (state[0] != 0.0);
+    ref_energy_ = state[1];
+    ref_energy_err_ = state[2];
+    ref_grad_norm_ = state[3];
+    success_num_ = size_t(state[4]);
+    return true;
+  }
+
+  bool operator==(const StepLengthController &rhs) const {
+    return grow_ == rhs.grow_ && shrink_ == rhs.shrink_ && min_step_ == rhs.min_step_ && max_step_ == rhs.max_step_
+        && reject_sigma_ == rhs.reject_sigma_ && has_reference_ == rhs.has_reference_
+        && ref_energy_ == rhs.ref_energy_ && ref_energy_err_ == rhs.ref_energy_err_
+        && ref_grad_norm_ == rhs.ref_grad_norm_ && success_num_ == rhs.success_num_;
+  }
+
+ private:
+  void SetReference_(const double energy, const double energy_err, const double grad_norm) {
+    ref_energy_ = energy;
+    ref_energy_err_ = energy_err;
+    ref_grad_norm_ = grad_norm;
+    has_reference_ = true;
+  }
+
+  double Clamp_(const double step_len) const {
+    double res = std::max(step_len, min_step_);
+    if (max_step_ > 0.0) {
+      res = std::min(res, max_step_);
+    }
+    return res;
+  }
+
+  double grow_;
+  double shrink_;
+  double min_step_;
+  double max_step_;     // 0 for no limit
+  double reject_sigma_;
+
+  bool has_reference_ = false;  // the reference is the last accepted TPS
+  double ref_energy_ = 0.0;
+  double ref_energy_err_ = 0.0;
+  double ref_grad_norm_ = 0.0;
+  size_t success_num_ = 0;      // number of the successive decreases
+};
+
+}//gqpeps
+
+#endif //GQPEPS_ALGORITHM_VMC_UPDATE_STEP_LENGTH_CONTROLLER_H
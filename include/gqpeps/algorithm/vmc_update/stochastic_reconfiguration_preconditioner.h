@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Preconditioners of the SMatrix in Stochastic Reconfiguration.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_STOCHASTIC_RECONFIGURATION_PRECONDITIONER_H
+#define GRACEQ_VMC_PEPS_STOCHASTIC_RECONFIGURATION_PRECONDITIONER_H
+
+#include <vector>
+#include <iostream>
+#include <algorithm>                                        //copy
+#include "boost/mpi.hpp"                                    //boost::mpi
+#include "gqpeps/consts.h"                                  //kMasterProc
+#include "gqpeps/two_dim_tn/tps/split_index_tps.h"          //SplitIndexTPS
+#include "gqpeps/algorithm/vmc_update/packed_o_matrix.h"    //PackedOMatrix
+#include "gqpeps/utility/cholesky_solver.h"                 //CholeskyDecompose, CholeskySubstitute
+#include "gqpeps/utility/mpi_type.h"                        //MPIDataType
+
+namespace gqpeps {
+using namespace gqten;
+
+enum SRPreconditionerType {
+  NoPreconditioner,         //0
+  JacobiPreconditioner,     //1, the diagonal of S
+  BlockJacobiPreconditioner //2, the diagonal blocks of S, one block for each component of each site
+};
+
+///< Blocks larger than this are preconditioned by Jacobi, the block costs max_block_size^2 memory.
+const size_t kDefaultSRPreconditionerMaxBlockSize = 2048;
+
+/**
+ * Preconditioner M ~ S for the conjugate gradient solver, where
+ *      S = <O^* O^T> - <O^*><O^*>^dag + diag_shift.
+ *
+ * The Jacobi preconditioner only needs sum_i |O_ik|^2, which is cheap from the packed samples.
+ * For the block Jacobi preconditioner, note for one sample only one component of each site is nonzero,
+ * so the blocks of different components on the same site only couple by the average term and are dropped.
+ * Each block is inverted by the Cholesky decomposition, and falls back to Jacobi if the decomposition fails.
+ * The cost of the blocks scales as (D^4 * d)^2 per site, so the blocks larger than max_block_size are not built
+ * and fall back to Jacobi as well. Master warns about the blocks falling back.
+ *
+ * The construction is collective. The blocks are reduced to and factorized in master, and for all_reduce = true
+ * the factors are broadcast. The preconditioner is only valid in the processors holding gten_ave,
+ * i.e. the master for all_reduce = false, and all the processors for all_reduce = true.
+ */
+template<typename TenElemT, typename QNT>
+class SRPreconditioner {
+  using SITPS = SplitIndexTPS<TenElemT, QNT>;
+ public:
+  SRPreconditioner(const SRPreconditionerType type,
+                   const PackedOMatrix<TenElemT, QNT> *gten_samples,
+                   const SITPS *gten_ave,
+                   const double diag_shift,
+                   const boost::mpi::communicator &world,
+                   const bool all_reduce,
+                   const size_t max_block_size = kDefaultSRPreconditionerMaxBlockSize) :
+      type_(type), gten_samples_(gten_samples), max_block_size_(max_block_size) {
+    valid_ = all_reduce || world.rank() == kMasterProc;
+    const double scale = 1.0 / double(gten_samples->SampleNum() * world.size());
+    std::vector<TenElemT> ave_flat;
+    if (valid_) {
+      gten_samples->Flatten(*gten_ave, ave_flat);
+    }
+    BuildDiagonal_(ave_flat, scale, diag_shift, world, all_reduce);
+    if (type_ == BlockJacobiPreconditioner) {
+      BuildBlocks_(ave_flat, scale, diag_shift, world, all_reduce);
+    }
+  }
+
+  ///< M^(-1) * r
+  SITPS operator()(const SITPS &r) const {
+    assert(valid_);
+    std::vector<TenElemT> r_flat;
+    gten_samples_->Flatten(r, r_flat);
+    if (type_ == BlockJacobiPreconditioner) {
+      const size_t block_num = blocks_.size();
+#pragma omp parallel for num_threads(hp_numeric::GetTensorManipulationThreads()) schedule(dynamic)
+      for (size_t b = 0; b < block_num; b++) {
+        TenElemT *seg = r_flat.data() + block_offset_[b];
+        if (block_is_factorized_[b]) {
+          CholeskySubstitute(blocks_[b], seg, block_size_[b]);
+        } else {
+          for (size_t k = 0; k < block_size_[b]; k++) {
+            seg[k] *= inv_diag_[block_offset_[b] + k];
+          }
+        }
+      }
+    } else {
+      for (size_t k = 0; k < r_flat.size(); k++) {
+        r_flat[k] *= inv_diag_[k];
+      }
+    }
+    return gten_samples_->Unflatten(r_flat);
+  }
+
+ private:
+  void BuildDiagonal_(const std::vector<TenElemT> &ave_flat, const double scale, const double diag_shift,
+                      const boost::mpi::communicator &world, const bool all_reduce) {
+    std::vector<double> diag(gten_samples_->ParamSize(), 0.0);
+    gten_samples_->AccumulateSquareDiagonal(diag);
+    Reduce_(diag, MPI_DOUBLE, world, all_reduce);
+    if (!valid_) {
+      return;
+    }
+    inv_diag_.resize(diag.size());
+    for (size_t k = 0; k < diag.size(); k++) {
+      inv_diag_[k] = InverseDiagonal_(diag[k] * scale - std::norm(ave_flat[k]) + diag_shift);
+    }
+  }
+
+  void BuildBlocks_(const std::vector<TenElemT> &ave_flat, const double scale, const double diag_shift,
+                    const boost::mpi::communicator &world, const bool all_reduce) {
+    std::vector<size_t> buffer_offset;
+    size_t buffer_size = 0;
+    for (size_t site = 0; site < gten_samples_->SiteNum(); site++) {
+      for (size_t compt = 0; compt < gten_samples_->ComponentNum(site); compt++) {
+        const size_t n = gten_samples_->ComponentSize(site, compt);
+        if (n == 0) {
+          continue;
+        }
+        block_offset_.push_back(gten_samples_->ComponentOffset(site, compt));
+        block_size_.push_back(n);
+        buffer_offset.push_back(buffer_size);
+        if (n <= max_block_size_) {
+          buffer_size += n * n;
+        }
+      }
+    }
+    const size_t block_num = block_size_.size();
+    std::vector<TenElemT> buffer(buffer_size, TenElemT(0));
+    size_t b = 0;
+    for (size_t site = 0; site < gten_samples_->SiteNum(); site++) {
+      for (size_t compt = 0; compt < gten_samples_->ComponentNum(site); compt++) {
+        if (gten_samples_->ComponentSize(site, compt) == 0) {
+          continue;
+        }
+        if (block_size_[b] <= max_block_size_) {
+          gten_samples_->AccumulateComponentBlock(site, compt, buffer.data() + buffer_offset[b]);
+        }
+        b++;
+      }
+    }
+    // the blocks are factorized once in master, and the factors are broadcast if all the processors need them.
+    MPI_Datatype data_type = MPIDataType<TenElemT>();
+    Reduce_(buffer, data_type, world, false);
+    block_is_factorized_.assign(block_num, 0);
+    if (world.rank() == kMasterProc) {
+      size_t oversize_num = 0, indefinite_num = 0;
+      for (b = 0; b < block_num; b++) {
+        const size_t n = block_size_[b];
+        if (n > max_block_size_) {
+          oversize_num++;
+          continue;
+        }
+        const TenElemT *ave = ave_flat.data() + block_offset_[b];
+        TenElemT *block = buffer.data() + buffer_offset[b];
+        for (size_t k = 0; k < n; k++) {
+          for (size_t l = 0; l < n; l++) {
+            block[k * n + l] = block[k * n + l] * scale - ave[k] * ConjugateElem(ave[l]);
+          }
+          block[k * n + k] += diag_shift;
+        }
+        std::vector<TenElemT> factor(block, block + n * n);
+        if (CholeskyDecompose(factor, n)) {
+          std::copy(factor.cbegin(), factor.cend(), block);
+          block_is_factorized_[b] = 1;
+        } else {
+          indefinite_num++;
+        }
+      }
+      if (oversize_num + indefinite_num > 0) {
+        std::cout << "warning: " << oversize_num + indefinite_num << " of " << block_num
+                  << " blocks of the block Jacobi preconditioner fall back to Jacobi, " << oversize_num
+                  << " larger than the max block size " << max_block_size_ << " and " << indefinite_num
+                  << " not positive definite." << std::endl;
+      }
+    }
+    if (all_reduce && world.size() > 1) {
+      ::MPI_Bcast(buffer.data(), buffer.size(), data_type, kMasterProc, MPI_Comm(world));
+      ::MPI_Bcast(block_is_factorized_.data(), block_num, MPI_CHAR, kMasterProc, MPI_Comm(world));
+    }
+    if (!valid_) {
+      return;
+    }
+    blocks_.resize(block_num);
+    for (b = 0; b < block_num; b++) {
+      if (block_is_factorized_[b]) {
+        const size_t n = block_size_[b];
+        blocks_[b].assign(buffer.begin() + buffer_offset[b], buffer.begin() + buffer_offset[b] + n * n);
+      }
+    }
+  }
+
+  ///< zero (numerically) diagonal elements are kept as identity
+  static double InverseDiagonal_(const double diag) {
+    return diag > kDiagonalCutoff ? 1.0 / diag : 1.0;
+  }
+
+  template<typename ElemT>
+  static void Reduce_(std::vector<ElemT> &data, MPI_Datatype data_type,
+                      const boost::mpi::communicator &world, const bool all_reduce) {
+    if (world.size() == 1) {
+      return;
+    }
+    if (all_reduce) {
+      ::MPI_Allreduce(MPI_IN_PLACE, data.data(), data.size(), data_type, MPI_SUM, MPI_Comm(world));
+    } else if (world.rank() == kMasterProc) {
+      ::MPI_Reduce(MPI_IN_PLACE, data.data(), data.size(), data_type, MPI_SUM, kMasterProc, MPI_Comm(world));
+    } else {
+      ::MPI_Reduce(data.data(), nullptr, data.size(), data_type, MPI_SUM, kMasterProc, MPI_Comm(world));
+    }
+  }
+
+  static constexpr double kDiagonalCutoff = 1e-15;
+
+  SRPreconditionerType type_;
+  const PackedOMatrix<TenElemT, QNT> *gten_samples_;
+  size_t max_block_size_;
+  bool valid_;
+  std::vector<double> inv_diag_;                  // Jacobi, also the fallback of the blocks
+  std::vector<std::vector<TenElemT>> blocks_;     // Cholesky factors of the blocks
+  std::vector<char> block_is_factorized_;
+  std::vector<size_t> block_offset_;              // offsets of the blocks in the flattened parameter vector
+  std::vector<size_t> block_size_;
+};
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_STOCHASTIC_RECONFIGURATION_PRECONDITIONER_H
@@ -10,6 +10,7 @@
 #define GRACEQ_VMC_PEPS_STOCHASTIC_RECONFIGURATION_SMATRIX_H
 
 #include "gqpeps/two_dim_tn/tps/split_index_tps.h"
+#include "gqpeps/algorithm/vmc_update/packed_o_matrix.h"    //PackedOMatrix
 #include "gqpeps/algorithm/vmc_update/wave_function_component_classes/square_tps_sample_nn_flip.h"
 
 namespace gqpeps {
@@ -19,17 +20,20 @@ template<typename TenElemT, typename QNT>
 class SRSMatrix {
   using SITPS = SplitIndexTPS<TenElemT, QNT>;
  public:
-  SRSMatrix(std::vector<SITPS> *gten_samples, SITPS *gten_ave,
+  SRSMatrix(const PackedOMatrix<TenElemT, QNT> *gten_samples, SITPS *gten_ave,
             size_t world_size) :
       gten_samples_(gten_samples), gten_ave_(gten_ave),
       world_size_(world_size) {}
 
   SITPS operator*(const SITPS &v0) const {
-    SITPS res = (*gten_samples_)[0] * ((*gten_samples_)[0] * v0);
-    for (size_t i = 1; i < gten_samples_->size(); i++) {
-      res += (*gten_samples_)[i] * ((*gten_samples_)[i] * v0);
+    std::vector<TenElemT> v_flat, res_flat;
+    gten_samples_->Flatten(v0, v_flat);
+    gten_samples_->MultiplyOOdag(v_flat, res_flat);
+    const double scale = 1.0 / double(gten_samples_->SampleNum() * world_size_);
+    for (TenElemT &elem : res_flat) {
+      elem *= scale;
     }
-    res *= 1.0 / double(gten_samples_->size() * world_size_);
+    SITPS res = gten_samples_->Unflatten(res_flat);
     if (gten_ave_ != nullptr) { //kMasterProc
       res += (-((*gten_ave_) * v0)) * (*gten_ave_);
       if (diag_shift != 0.0) {
@@ -41,7 +45,7 @@ class SRSMatrix {
 
   TenElemT diag_shift = 0.0;
  private:
-  std::vector<SITPS> *gten_samples_;
+  const PackedOMatrix<TenElemT, QNT> *gten_samples_;
   SITPS *gten_ave_;
   size_t world_size_;
 };
@@ -27,13 +27,19 @@ enum WAVEFUNCTION_UPDATE_SCHEME {
   RandomGradientElement,                  //5
   BoundGradientElement,                   //6
   GradientLineSearch,                     //7
-  NaturalGradientLineSearch               //8
+  NaturalGradientLineSearch,              //8
+  SampleSpaceStochasticReconfiguration,   //9, natural gradient solved in the sample space (minSR)
+  Momentum,                               //10
+  NesterovMomentum,                       //11
+  Adam,                                   //12
+  KrylovSubspaceSR                        //13, SR by the energy eigenproblem in the Krylov subspace {g, S g, ...}
 };
 
 const std::vector<WAVEFUNCTION_UPDATE_SCHEME> stochastic_reconfiguration_method({StochasticReconfiguration,
                                                                                  RandomStepStochasticReconfiguration,
                                                                                  NormalizedStochasticReconfiguration,
-                                                                                 NaturalGradientLineSearch});
+                                                                                 NaturalGradientLineSearch,
+                                                                                 SampleSpaceStochasticReconfiguration});
 
 enum MC_SWEEP_SCHEME {  // 5th Jan, 2024 note : useless definition
   SequentiallyNNSiteFlip,
@@ -41,6 +47,16 @@ enum MC_SWEEP_SCHEME {  // 5th Jan, 2024 note : useless definition
 };
 
 
+///< the configurations of the chain (> 0) are dumped in the sub-directory of the wavefunction path
+inline std::string ChainConfigurationPath(const std::string &wavefunction_path, const size_t chain) {
+  return wavefunction_path + "/chain" + std::to_string(chain);
+}
+
+///< the random stream of the processor (not of the chains) is dumped in the sub-directory of the wavefunction path
+inline std::string ProcessorStreamPath(const std::string &wavefunction_path) {
+  return wavefunction_path + "/processor";
+}
+
 struct VMCOptimizePara {
   VMCOptimizePara(void) = default;
 
@@ -119,6 +135,96 @@ struct VMCOptimizePara {
   std::string wavefunction_path;
 
   MC_SWEEP_SCHEME mc_sweep_scheme = SequentiallyNNSiteFlip;
+
+  ///< if true, the averaged gradient (and O^* average for SR) are obtained in all the processors by MPI_Allreduce,
+  ///< otherwise only in master by MPI_Reduce.
+  bool grad_all_reduce = false;
+
+  ///< if true, the update direction is obtained in all the processors by MPI_Allreduce, and every processor
+  ///< applies the same update itself instead of receiving the updated TPS broadcast from master.
+  ///< It implies grad_all_reduce, and MasterSlaveCG is replaced by AllReduceCG.
+  bool replicated_update = false;
+  ///< in the replicated update, the TPS checksums are compared every replica_check_interval steps (0 for never),
+  ///< and the TPS of master is broadcast if the replicas differ.
+  size_t replica_check_interval = 10;
+
+  ///< checkpoints of the iterative optimization are dumped every checkpoint_interval iterations
+  ///< and/or every checkpoint_time_interval seconds, 0 for never. See VMCPEPSExecutor::Resume.
+  size_t checkpoint_interval = 0;
+  double checkpoint_time_interval = 0.0;
+  std::string checkpoint_path = kCheckpointPath;
+
+  ///< walltime budget in seconds, counted from the construction of the executor. 0 for no limit.
+  ///< Before the budget runs out, the executors stop sampling, dump the data (and the checkpoint) and return.
+  double walltime_budget = 0.0;
+  ///< stop in the same way when SIGTERM or SIGUSR1 is received, which the job schedulers send before the kill.
+  bool trap_preemption_signals = false;
+  ///< shorten step_lens by the measured time of the iterations, so that the optimization ends within the budget.
+  bool fit_schedule_to_walltime = false;
+  ///< with the walltime budget or the trapped signals, the sampling is interrupted between the blocks of
+  ///< preemption_poll_samples samples per processor (0 for mc_samples / 10), and the interrupted iteration is dropped.
+  size_t preemption_poll_samples = 0;
+
+  ///< SampleSpaceStochasticReconfiguration: times the diagonal shift (ConjugateGradientParams::diag_shift) is
+  ///< enlarged by 10 when the Cholesky decomposition fails, after which the plain gradient is used instead.
+  size_t max_shift_retry = 8;
+
+  ///< adaptive sample number. If any of the targets is positive, the samples are drawn in blocks of
+  ///< adaptive_sample_block samples per processor (0 for mc_samples / 10), until the relative standard errors of
+  ///< the energy and (for the gradient samplings) the gradient norm are below the positive targets.
+  ///< mc_samples is then the maximum number of samples per processor, and adaptive_min_samples the minimum.
+  double energy_target_relative_error = 0.0;
+  double grad_target_relative_error = 0.0;
+  size_t adaptive_sample_block = 0;
+  size_t adaptive_min_samples = 0;
+
+  ///< in the line search, estimate the energies at the strides by reweighting the configurations sampled at the
+  ///< initial TPS with |psi_new / psi_old|^2 (correlated sampling), instead of the fresh samplings.
+  ///< A stride falls back to the fresh sampling if the effective sample size ratio is below reweighting_min_ess_ratio.
+  bool line_search_reweighting = false;
+  double reweighting_min_ess_ratio = 0.5;
+  ///< number of the processor groups in the line search, which evaluate different strides at the same time.
+  ///< Each stride is then sampled by one group only.
+  size_t line_search_groups = 1;
+
+  ///< parameters of the Momentum, NesterovMomentum and Adam schemes, see MomentumOptimizer.
+  ///< The step lengths are still given by step_lens.
+  ///< There is no weight decay (AdamW): the decay T -> (1 - step_len * decay) T only rescales the site tensors,
+  ///< which is undone by their normalization after each update.
+  double momentum = 0.9;
+  double adam_beta1 = 0.9;
+  double adam_beta2 = 0.999;
+  double adam_epsilon = 1e-8;
+
+  ///< KrylovSubspaceSR, see KrylovSRSubspace: the energy is minimized in the Krylov subspace {g, S g, S^2 g, ...}
+  ///< of dimension krylov_sr_dim, with the S matrix and the local energies of the SR samples. It is not the linear
+  ///< method of Umrigar and Sorella: the derivatives of the local energies are not sampled, so their term is missing
+  ///< in the subspace Hamiltonian. krylov_sr_shift (times S) stabilizes the update, and krylov_sr_xi normalizes the
+  ///< parameter changes. step_lens scales the update, 1 for the full step.
+  size_t krylov_sr_dim = 4;
+  double krylov_sr_shift = 1e-2;
+  double krylov_sr_xi = 0.5;
+
+  ///< adapt the step length of the iterative optimization by the energy feedback, see StepLengthController.
+  ///< step_lens[0] is the initial step length. If adaptive_iteration_num > 0, it is the number of iterations,
+  ///< otherwise the number is step_lens.size(). An update is rejected (the previous TPS is restored) if the energy
+  ///< increases beyond step_reject_sigma error bars. step_len_max = 0 for no upper limit.
+  bool adaptive_step_len = false;
+  size_t adaptive_iteration_num = 0;
+  double step_len_grow = 1.2;
+  double step_len_shrink = 0.5;
+  double step_len_min = 0.0;
+  double step_len_max = 0.0;
+  double step_reject_sigma = 2.0;
+
+  ///< number of independent Markov chains in each processor, which are sampled in parallel by OpenMP threads.
+  ///< mc_samples is the total number of samples of all the chains in one processor.
+  ///< With several chains, the threads of the tensor manipulations should be reduced accordingly.
+  size_t chains_per_proc = 1;
+
+  ///< seed of the random number streams, the stream of each chain is labeled by (random_seed, rank, chain).
+  ///< 0 means a seed drawn from std::random_device by master, which is printed so that the run can be reproduced.
+  uint64_t random_seed = 0;
 };
 
 }//gqpeps
@@ -10,22 +10,46 @@
 #ifndef GQPEPS_ALGORITHM_VMC_UPDATE_VMC_UPDATE_H
 #define GQPEPS_ALGORITHM_VMC_UPDATE_VMC_UPDATE_H
 
+#include <chrono>                                   //steady_clock
+#include <array>
+#include <tuple>
 #include "boost/mpi.hpp"                            //boost::mpi
 
 #include "gqpeps/two_dim_tn/tps/tps.h"              // TPS
 #include "gqpeps/two_dim_tn/tps/split_index_tps.h"  //SplitIndexTPS
 
 #include "gqpeps/algorithm/vmc_update/vmc_optimize_para.h"  //VMCOptimizePara
+#include "gqpeps/monte_carlo_tools/random_stream.h"         //RandomStream
+#include "gqpeps/utility/background_writer.h"               //BackgroundWriter
+#include "gqpeps/utility/preemption.h"                      //WalltimeBudget, TrapPreemptionSignals
+#include "gqpeps/algorithm/vmc_update/packed_o_matrix.h"     //PackedOMatrix
+#include "gqpeps/algorithm/vmc_update/momentum_optimizer.h"  //MomentumOptimizer
+#include "gqpeps/algorithm/vmc_update/krylov_subspace_sr.h"       //KrylovSRSubspace
+#include "gqpeps/algorithm/vmc_update/step_length_controller.h" //StepLengthController
+#include "gqpeps/monte_carlo_tools/sample_moments.h"           //SampleMoments
+#include "gqpeps/monte_carlo_tools/reweighting.h"              //ReweightingSums
+#include "gqpeps/algorithm/vmc_update/stochastic_reconfiguration_preconditioner.h" //SRPreconditionerType
 
 namespace gqpeps {
 using namespace gqten;
 
+enum ConjugateGradientParallelScheme {
+  MasterSlaveCG,  //0, master does the vector algebra, the others only do the matrix multiplication
+  AllReduceCG     //1, all processors do the vector algebra, one MPI_Allreduce per matrix multiplication
+};
+
 ///< For stochastic reconfiguration
 struct ConjugateGradientParams {
   size_t max_iter;
   double tolerance;
   int residue_restart_step;
   double diag_shift;
+  ConjugateGradientParallelScheme parallel_scheme = MasterSlaveCG;
+  SRPreconditionerType preconditioner = NoPreconditioner;
+  ///< BlockJacobiPreconditioner only: the blocks (one per component of each site) larger than this fall back to
+  ///< Jacobi. A block of n elements costs n^2 memory in every processor; the bulk blocks have D^4 elements without
+  ///< the symmetry, so the default 2048 covers D <= 6.
+  size_t precond_max_block_size = kDefaultSRPreconditionerMaxBlockSize;
 
   ConjugateGradientParams(size_t max_iter, double tolerance, int residue_restart_step, double diag_shift)
       : max_iter(max_iter), tolerance(tolerance), residue_restart_step(residue_restart_step), diag_shift(diag_shift) {}
@@ -65,6 +89,10 @@ class VMCPEPSExecutor : public Executor {
 
   void Execute(void) override;
 
+  ///< Execute from the latest checkpoint in optimize_para.checkpoint_path without warm up,
+  ///< or from the beginning if there is no checkpoint.
+  void Resume(void);
+
   void LoadTenData(void);
 
   void LoadTenData(const std::string &tps_path);
@@ -73,6 +101,9 @@ class VMCPEPSExecutor : public Executor {
 
   void DumpData(const std::string &tps_path, const bool release_mem = false);
 
+  ///< collective, compare the checksums of the TPS in all the processors. Useful for the replicated update.
+  bool CheckTPSReplicas(void);
+
   VMCOptimizePara optimize_para;
 
   ConjugateGradientParams cg_params = ConjugateGradientParams(100, 1e-8, 20, 1e-2);
@@ -87,61 +118,135 @@ class VMCPEPSExecutor : public Executor {
 
   // Level 2 Member Functions
   void PrintExecutorInfo_(void);
+  bool CheckpointDue_(const size_t iter);
+  bool PreemptionDue_(const double step_time);
+  bool PreemptionDue_(const double step_time, const boost::mpi::communicator &comm);
+  bool PreemptionPossible_(void) const;
+  bool RecordOSamples_(void) const;
+  void FitScheduleToWalltime_(const size_t iter, const double iter_time);
+  void DumpCheckpoint_(const size_t iter);
+  bool LoadCheckpoint_(void);
+  void DumpChainStates_(const std::string &tps_path);
   void ReserveSamplesDataSpace_(void);
 
   void IterativeOptimizeTPSStep_(const size_t iter);
+  void InitStepLengthController_(void);
+  bool AdaptStepLength_(const size_t iter);
+  void RejectLastUpdate_(void);
   void LineSearch_(const SITPST &search_dir,
                    const std::vector<double> &strides);
+  void LineSearchInGroups_(const SITPST &search_dir,
+                           const std::vector<double> &strides);
 
   // Level 3 Member Functions
-  void UpdateTPSByVecAndSynchronize_(const VMCPEPSExecutor::SITPST &grad, double step_len);
+  void UpdateTPSByVecAndSynchronize_(const VMCPEPSExecutor::SITPST &grad, double step_len,
+                                     const bool rebuild_chains = true);
   void BoundGradElementUpdateTPS_(VMCPEPSExecutor::SITPST &grad, double step_len);
+  bool KrylovSubspaceSRUpdateTPS_(double step_len, double &predicted_energy);
+  bool KrylovSubspaceSRUpdate_(SITPST &update, double &predicted_energy);
+  std::vector<TenElemT> ApplySMatrix_(const std::vector<TenElemT> &v_flat, const std::vector<TenElemT> &ave_flat);
+  void SynchronizeUpdatedTPS_(const std::vector<size_t> &signature_before_update, const bool rebuild_chains = true);
+  void RebuildChains_(void);
+  ConjugateGradientParallelScheme CGParallelScheme_(void) const;
   std::pair<size_t, double> StochReconfigUpdateTPS_(const VMCPEPSExecutor::SITPST &grad,
                                                     double step_len,
                                                     const SITPST &init_guess,
                                                     const bool normalize_natural_grad);
 
+  ///< runtime data of one Markov chain. The chains in one processor are sampled in parallel threads.
+  struct MarkovChain {
+    WaveFunctionComponentType tps_sample;
+    EnergySolver energy_solver;
+    RandomStream rand_stream;
+    TensorNetwork2D<TenElemT, QNT> holes; // reused by every sample
+    std::vector<TenElemT> energy_samples;
+    SITPST gten_sum;
+    SITPST g_times_energy_sum;
+    ///< partial sums of the samples in the current block,
+    ///< flushed into the above sums every accumulate_block_size_ samples
+    SITPST gten_block_sum;
+    SITPST g_times_energy_block_sum;
+    size_t sample_num;      // number of samples of this chain in the current block of the sampling
+    size_t sample_offset;   // index of the first sample of this chain (in the current block) in the processor
+    SampleMoments moments;  // for the adaptive sampling
+    ///< the sampled configurations and their amplitudes, recorded for the reweighting in the line search
+    std::vector<Configuration> config_samples;
+    std::vector<TenElemT> amplitude_samples;
+    std::vector<double> accept_rates_accum;
+
+    MarkovChain(const size_t ly, const size_t lx, const EnergySolver &solver) :
+        tps_sample(ly, lx), energy_solver(solver), holes(ly, lx),
+        gten_sum(ly, lx), g_times_energy_sum(ly, lx), gten_block_sum(ly, lx), g_times_energy_block_sum(ly, lx),
+        sample_num(0), sample_offset(0) {}
+  };
+
   // Lowest Level Member functions who could directly change data
   ///< functions who cloud directly act on sample data
-  TenElemT SampleEnergy_(void);
-  void SampleEnergyAndHols_(void);
+  void InitRandomStreams_(void);
+  void InitChains_(const Configuration &config);
+  std::vector<double> SampleChains_(const bool calc_holes, const bool record_configs = false);
+  void SampleChainsBlock_(const bool calc_holes, const bool record_configs);
+  bool AdaptiveSampling_(void) const;
+  double BMPSSweepsPerCompression_(void);
+  bool SamplingConverged_(const bool calc_holes);
+  TenElemT SampleEnergy_(MarkovChain &chain);
+  void SampleEnergyAndHols_(MarkovChain &chain, const size_t sample_idx);
   void ClearEnergyAndHoleSamples_(void);
+  void ResetGradientAccumulators_(void);
+  void FlushGradientBlockSum_(MarkovChain &chain);
 
   ///< statistic and gradient operation functions
   ///< return the gradient;
   SITPST GatherStatisticEnergyAndGrad_(void);
+  std::tuple<TenElemT, double, double> ReweightedEnergy_(void);
   void GradientRandElementSign_();
   size_t CalcNaturalGradient_(const VMCPEPSExecutor::SITPST &grad, const SITPST &init_guess);
+  size_t CalcNaturalGradientInSampleSpace_(const SITPST &grad);
 
-  std::vector<double> MCSweep_(void);
+  std::vector<double> MCSweep_(MarkovChain &chain);
   // Input Data Region
   const boost::mpi::communicator world_;
 
   size_t lx_; //cols
   size_t ly_; //rows
 
-  EnergySolver energy_solver_;
+  EnergySolver energy_solver_; // copied into each chain
 
   //Runtime Data Region
   SITPST split_index_tps_;  //also can be input/output
   bool warm_up_;
   bool stochastic_reconfiguration_update_class_;
-  WaveFunctionComponentType tps_sample_;
-
-  std::vector<TenElemT> energy_samples_;
+  std::vector<MarkovChain> chains_;
+  ///< the processors which share the samples, i.e. world_, or one group in the parallel line search
+  boost::mpi::communicator sampling_comm_ = world_;
+  size_t start_iter_ = 0;      // the first iteration, nonzero if resumed from a checkpoint
+  std::chrono::steady_clock::time_point last_checkpoint_time_ = std::chrono::steady_clock::now();
+  BackgroundWriter checkpoint_writer_;   // used in master
+  WalltimeBudget walltime_;
+  bool preempted_ = false;
+  uint64_t random_seed_;       // same in all the processors
+  RandomStream rand_stream_;   // processor level random numbers, e.g. the random step length
+
+  std::vector<TenElemT> energy_samples_; // samples of all the chains, in the order of the blocks and the chains
+  size_t sample_num_ = 0;                // number of samples per processor in the last sampling
   ///<outside vector indices corresponding to the local hilbert space basis
 //  DuoMatrix<std::vector<std::vector<Tensor *> >> gten_samples_;
 //  DuoMatrix<std::vector<std::vector<Tensor *> >> g_times_energy_samples_;
 
-  ///< vector index corresponding to the samples.
-  std::vector<SITPST> gten_samples_; //useful for stochastic reconfiguration
+  ///< O^*(S) of the samples, packed in a dense matrix. useful for stochastic reconfiguration
+  PackedOMatrix<TenElemT, QNT> gten_samples_;
 
-  SITPST gten_sum_; // the holes * psi^(-1)
+  SITPST gten_sum_; // the holes * psi^(-1), summed over the chains
   SITPST gten_ave_; // average of gten_sum_;
   SITPST g_times_energy_sum_;
+  size_t accumulate_block_size_;
 
   SITPST grad_;
   SITPST natural_grad_;
+  MomentumOptimizer<TenElemT, QNT> momentum_optimizer_; // in the processors which apply the update
+  StepLengthController step_len_controller_; // in master
+  SITPST tps_before_update_;          // in the processors which apply the update, for the rejection of the update
+  MomentumOptimizer<TenElemT, QNT> optimizer_before_update_; // as above, the moments and the step counter
   std::vector<double> grad_norm_;
 
   //Output/Dump Data Region
@@ -11,8 +11,13 @@
 #define GQPEPS_ALGORITHM_VMC_UPDATE_VMC_PEPS_IMPL_H
 
 #include <iomanip>
+#include <numeric>
+#include <algorithm>    //all_of
+#include <filesystem>   //remove_all, rename
 #include "gqpeps/algorithm/vmc_update/stochastic_reconfiguration_smatrix.h" //SRSMatrix
 #include "gqpeps/utility/conjugate_gradient_solver.h"
+#include "gqpeps/utility/cholesky_solver.h"
+#include "gqpeps/utility/mpi_type.h"                //MPIDataType
 #include "gqpeps/algorithm/vmc_update/axis_update.h"
 #include "gqpeps/monte_carlo_tools/statistics.h"
 
@@ -81,7 +86,6 @@ VMCPEPSExecutor<TenElemT,
     lx_(sitpst_init.cols()),
     ly_(sitpst_init.rows()),
     split_index_tps_(sitpst_init),
-    tps_sample_(ly_, lx_),
     grad_(ly_, lx_),
     natural_grad_(ly_, lx_),
 //    gten_samples_(ly_, lx_),
@@ -90,9 +94,13 @@ VMCPEPSExecutor<TenElemT,
     g_times_energy_sum_(ly_, lx_),
     energy_solver_(solver),
     warm_up_(false) {
-  random_engine.seed(std::random_device{}() + 10086 * world.rank());
   WaveFunctionComponentType::trun_para = BMPSTruncatePara(optimize_para);
-  tps_sample_ = WaveFunctionComponentType(sitpst_init, optimize_para.init_config);
+  walltime_ = WalltimeBudget(optimize_para.walltime_budget);
+  if (optimize_para.trap_preemption_signals) {
+    TrapPreemptionSignals();
+  }
+  InitRandomStreams_();
+  InitChains_(optimize_para.init_config);
   if (std::find(stochastic_reconfiguration_method.cbegin(),
                 stochastic_reconfiguration_method.cend(),
                 optimize_para.update_scheme) != stochastic_reconfiguration_method.cend()) {
@@ -100,6 +108,7 @@ VMCPEPSExecutor<TenElemT,
   } else {
     stochastic_reconfiguration_update_class_ = false;
   }
+  InitStepLengthController_();
   ReserveSamplesDataSpace_();
   PrintExecutorInfo_();
   this->SetStatus(ExecutorStatus::INITED);
@@ -114,14 +123,18 @@ VMCPEPSExecutor<TenElemT,
                                                             const boost::mpi::communicator &world,
                                                             const EnergySolver &solver):
     world_(world), optimize_para(optimize_para), lx_(lx), ly_(ly),
-    split_index_tps_(ly, lx), tps_sample_(ly, lx),
+    split_index_tps_(ly, lx),
     grad_(ly_, lx_), natural_grad_(ly_, lx_),
 //    gten_samples_(ly_, lx_),
 //    g_times_energy_samples_(ly_, lx_),
     gten_sum_(ly_, lx_), g_times_energy_sum_(ly_, lx_),
     energy_solver_(solver), warm_up_(false) {
   WaveFunctionComponentType::trun_para = BMPSTruncatePara(optimize_para);
-  random_engine.seed(std::random_device{}() + 10086 * world.rank());
+  walltime_ = WalltimeBudget(optimize_para.walltime_budget);
+  if (optimize_para.trap_preemption_signals) {
+    TrapPreemptionSignals();
+  }
+  InitRandomStreams_();
   if (std::find(stochastic_reconfiguration_method.cbegin(),
                 stochastic_reconfiguration_method.cend(),
                 optimize_para.update_scheme) != stochastic_reconfiguration_method.cend()) {
@@ -130,6 +143,7 @@ VMCPEPSExecutor<TenElemT,
     stochastic_reconfiguration_update_class_ = false;
   }
   LoadTenData();
+  InitStepLengthController_();
   ReserveSamplesDataSpace_();
   PrintExecutorInfo_();
   this->SetStatus(ExecutorStatus::INITED);
@@ -146,27 +160,15 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Ex
   }
   Measure_();
   DumpData();
+  checkpoint_writer_.Flush();
   SetStatus(ExecutorStatus::FINISH);
 }
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::ReserveSamplesDataSpace_(void) {
   energy_samples_.reserve(optimize_para.mc_samples);
-  for (size_t row = 0; row < ly_; row++) {
-    for (size_t col = 0; col < lx_; col++) {
-      size_t dim = split_index_tps_({row, col}).size();
-
-//      gten_samples_({row, col}) = std::vector(dim, std::vector<Tensor *>());
-//      g_times_energy_samples_({row, col}) = std::vector(dim, std::vector<Tensor *>());
-//      for (size_t i = 0; i < dim; i++) {
-//        gten_samples_({row, col})[i].reserve(optimize_para.mc_samples);
-//        g_times_energy_samples_({row, col})[i].reserve(optimize_para.mc_samples);
-//      }
-
-      gten_sum_({row, col}) = std::vector<Tensor>(dim, Tensor(split_index_tps_({row, col})[0].GetIndexes()));
-      g_times_energy_sum_({row, col}) = gten_sum_({row, col});
-    }
-  }
+  accumulate_block_size_ = std::max<size_t>(1, std::sqrt(double(optimize_para.mc_samples)));
+  ResetGradientAccumulators_();
   for (size_t row = 0; row < ly_; row++)
     for (size_t col = 0; col < lx_; col++) {
       size_t dim = split_index_tps_({row, col}).size();
@@ -181,7 +183,6 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Re
     grad_norm_.reserve(optimize_para.step_lens.size());
 
   if (stochastic_reconfiguration_update_class_) {
-    gten_samples_.reserve(optimize_para.mc_samples);
     for (size_t row = 0; row < ly_; row++)
       for (size_t col = 0; col < lx_; col++) {
         size_t dim = split_index_tps_({row, col}).size();
@@ -202,13 +203,21 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Pr
     std::cout << std::setw(30) << "BMPS bond dimension:" << optimize_para.bmps_trunc_para.D_min << "/"
               << optimize_para.bmps_trunc_para.D_max << "\n";
     std::cout << std::setw(30) << "Sampling numbers:" << optimize_para.mc_samples << "\n";
+    if (AdaptiveSampling_()) {
+      std::cout << std::setw(30) << "Adaptive sampling targets:" << optimize_para.energy_target_relative_error
+                << " (energy), " << optimize_para.grad_target_relative_error << " (gradient)\n";
+    }
     std::cout << std::setw(30) << "Gradient update times:" << optimize_para.step_lens.size() << "\n";
+    if (optimize_para.adaptive_step_len) {
+      std::cout << std::setw(30) << "Adaptive step length from:" << optimize_para.step_lens.front() << "\n";
+    }
     std::cout << std::setw(30) << "PEPS update strategy:" << optimize_para.update_scheme << "\n";
 
     std::cout << "=====> TECHNICAL PARAMETERS <=====" << "\n";
     std::cout << std::setw(40) << "The number of processors (including master):" << world_.size() << "\n";
     std::cout << std::setw(40) << "The number of threads per processor:" << hp_numeric::GetTensorManipulationThreads()
               << "\n";
+    std::cout << std::setw(40) << "Random seed:" << random_seed_ << "\n";
   }
 }
 
@@ -216,8 +225,11 @@ template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFu
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::WarmUp_(void) {
   if (!warm_up_) {
     Timer warm_up_timer("warm_up");
-    for (size_t sweep = 0; sweep < optimize_para.mc_warm_up_sweeps; sweep++) {
-      MCSweep_();
+#pragma omp parallel for num_threads(chains_.size()) schedule(static, 1) if(chains_.size() > 1)
+    for (size_t c = 0; c < chains_.size(); c++) {
+      for (size_t sweep = 0; sweep < optimize_para.mc_warm_up_sweeps; sweep++) {
+        MCSweep_(chains_[c]);
+      }
     }
     double elasp_time = warm_up_timer.Elapsed();
     std::cout << "Proc " << std::setw(4) << world_.rank() << " warm up completes T = " << elasp_time << "s."
@@ -228,24 +240,16 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Wa
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::LineSearchOptimizeTPS_(void) {
-  std::vector<double> accept_rates_accum;
   ClearEnergyAndHoleSamples_();
 
   Timer grad_calculation_timer("gradient_calculation");
-  for (size_t sweep = 0; sweep < optimize_para.mc_samples; sweep++) {
-    std::vector<double> accept_rates = MCSweep_();
-    if (sweep == 0) {
-      accept_rates_accum = accept_rates;
-    } else {
-      for (size_t i = 0; i < accept_rates_accum.size(); i++) {
-        accept_rates_accum[i] += accept_rates[i];
-      }
+  std::vector<double> accept_rates_avg = SampleChains_(true, optimize_para.line_search_reweighting);
+  if (preempted_) {
+    if (world_.rank() == kMasterProc) {
+      std::cout << "Stop the line search before the search direction because of the preemption signal "
+                << "or the walltime budget." << std::endl;
     }
-    SampleEnergyAndHols_();
-  }
-  auto accept_rates_avg = accept_rates_accum;
-  for (double &rates : accept_rates_avg) {
-    rates /= double(optimize_para.mc_samples);
+    return;
   }
   GatherStatisticEnergyAndGrad_();
 
@@ -254,14 +258,14 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Li
   SITPST *search_dir(nullptr);
   switch (optimize_para.update_scheme) {
     case GradientLineSearch: {
-      if (world_.rank() == kMasterProc)
+      if (world_.rank() == kMasterProc || optimize_para.replicated_update)
         search_dir = &grad_;
       break;
     }
     case NaturalGradientLineSearch: {
       auto init_guess = SITPST(ly_, lx_, split_index_tps_.PhysicalDim());
       cgsolver_iter = CalcNaturalGradient_(grad_, init_guess);
-      if (world_.rank() == kMasterProc) {
+      if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
         search_dir = &natural_grad_;
         sr_natural_grad_norm = natural_grad_.NormSquare();
       }
@@ -286,6 +290,9 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Li
       std::cout << std::setw(5) << std::fixed << std::setprecision(2) << rate;
     }
     std::cout << "]";
+    if (AdaptiveSampling_()) {
+      std::cout << "Samples = " << std::setw(8) << sample_num_ * world_.size();
+    }
     if (stochastic_reconfiguration_update_class_) {
       std::cout << "SRSolver Iter = " << std::setw(4) << cgsolver_iter;
       std::cout << "NGrad norm = " << std::setw(9) << std::scientific << std::setprecision(1) << sr_natural_grad_norm;
@@ -301,43 +308,61 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Li
                                                                                                               QNT> &search_dir,
                                                                                           const std::vector<double> &strides) {
 
+  if (optimize_para.line_search_groups > 1 && world_.size() > 1) {
+    LineSearchInGroups_(search_dir, strides);
+    return;
+  }
+  const bool replicated = optimize_para.replicated_update;
   double e0_min;
   if (world_.rank() == kMasterProc) {
     e0_min = energy_trajectory_[0];
   }
+  if (replicated) {
+    boost::mpi::broadcast(world_, e0_min, kMasterProc);
+  }
   SplitIndexTPS tps_min = split_index_tps_;
+  // the chains keep the configurations of the initial TPS, see LineSearchOptimizeTPS_
+  bool reweighting = optimize_para.line_search_reweighting && !chains_[0].config_samples.empty();
   for (size_t point = 0; point < strides.size(); point++) {
+    const auto point_start = std::chrono::steady_clock::now();
     Timer energy_measure_timer("energy_measure");
-    UpdateTPSByVecAndSynchronize_(search_dir, strides[point]);
-    ClearEnergyAndHoleSamples_();
-    std::vector<double> accept_rates_accum;
-    for (size_t sweep = 0; sweep < optimize_para.mc_samples; sweep++) {
-      std::vector<double> accept_rates = MCSweep_();
-      if (sweep == 0) {
-        accept_rates_accum = accept_rates;
-      } else {
-        for (size_t i = 0; i < accept_rates_accum.size(); i++) {
-          accept_rates_accum[i] += accept_rates[i];
+    UpdateTPSByVecAndSynchronize_(search_dir, strides[point], !reweighting);
+    TenElemT energy;
+    double en_err;
+    double ess_ratio = -1.0;
+    bool reweighted = false;
+    std::vector<double> accept_rates_avg;
+    if (reweighting) {
+      std::tie(energy, en_err, ess_ratio) = ReweightedEnergy_();
+      reweighted = (ess_ratio >= optimize_para.reweighting_min_ess_ratio);
+      if (!reweighted) {
+        // the later strides are usually farther from the initial TPS, so the fresh sampling is used for the rest
+        reweighting = false;
+        RebuildChains_();
+      }
+    }
+    if (!reweighted) {
+      ClearEnergyAndHoleSamples_();
+      accept_rates_avg = SampleChains_(false);
+      if (preempted_) {
+        if (world_.rank() == kMasterProc) {
+          std::cout << "Stop the line search at stride " << strides[point]
+                    << " because of the preemption signal or the walltime budget." << std::endl;
         }
+        break;
       }
-      SampleEnergy_();
+      TenElemT en_self = Mean(energy_samples_); //energy value in each processor
+      std::tie(energy, en_err) = GatherStatisticSingleData(en_self, MPI_Comm(world_));
+      gqten::hp_numeric::MPI_Bcast(&energy, 1, kMasterProc, MPI_Comm(world_));
+    }
+    if ((world_.rank() == kMasterProc || replicated) && energy < e0_min) {
+      e0_min = energy;
+      tps_min = split_index_tps_;
     }
-    TenElemT en_self = Mean(energy_samples_); //energy value in each processor
-    auto [energy, en_err] = GatherStatisticSingleData(en_self, MPI_Comm(world_));
-    gqten::hp_numeric::MPI_Bcast(&energy, 1, kMasterProc, MPI_Comm(world_));
     if (world_.rank() == 0) {
       energy_trajectory_.push_back(energy);
       energy_error_traj_.push_back(en_err);
 
-      auto accept_rates_avg = accept_rates_accum;
-      for (double &rates : accept_rates_avg) {
-        rates /= double(optimize_para.mc_samples);
-      }
-      if (energy < e0_min) {
-        e0_min = energy;
-        tps_min = split_index_tps_;
-      }
-
       //cout
       double energy_measure_time = energy_measure_timer.Elapsed();
       std::cout << "Stride :" << std::setw(9) << optimize_para.step_lens[point]
@@ -350,20 +375,252 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Li
         std::cout << std::setw(5) << std::fixed << std::setprecision(2) << rate;
       }
       std::cout << "]";
+      if (AdaptiveSampling_()) {
+        std::cout << "Samples = " << std::setw(8) << sample_num_ * world_.size();
+      }
+      if (ess_ratio >= 0.0) {
+        std::cout << "ESS ratio = " << std::setw(5) << std::fixed << std::setprecision(2) << ess_ratio
+                  << (reweighted ? "" : " (resampled)");
+      }
 
       std::cout << " TotT = " << std::setw(8) << std::fixed << std::setprecision(2) << energy_measure_time << "s"
                 << std::endl;
     }
+    const double point_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - point_start).count();
+    if (point + 1 < strides.size() && PreemptionDue_(point_time)) {
+      if (world_.rank() == kMasterProc) {
+        std::cout << "Stop the line search because of the preemption signal or the walltime budget." << std::endl;
+      }
+      preempted_ = true;
+      break;
+    }
   }
-  if (world_.rank() == kMasterProc) {
+  if (world_.rank() == kMasterProc || replicated) {
     split_index_tps_ = tps_min;
   }
+  if (replicated) {
+    RebuildChains_();
+  }
+}
+
+/**
+ * The line search with the strides evaluated at the same time by line_search_groups groups of processors.
+ * Group g evaluates the strides g, g + G, ... on its own TPS replica, which is obtained from the initial TPS
+ * by the same sequence of updates as in LineSearch_, so no TPS is communicated.
+ * The energies are collected by one reduction, and all the processors rebuild the TPS of the lowest energy.
+ *
+ * Each stride is sampled by one group, so its error bar is larger than the one sampled by all the processors.
+ * The preemption is polled by each group between its strides and in its sampling (see SampleChains_).
+ * Once a group is preempted it stops and its remaining strides are not evaluated; the strides evaluated by all the
+ * groups still take part in the choice of the lowest energy.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::LineSearchInGroups_(
+    const SITPST &search_dir, const std::vector<double> &strides) {
+  Timer line_search_timer("line_search");
+  const size_t group_num = std::min<size_t>(optimize_para.line_search_groups, world_.size());
+  const size_t group = world_.rank() % group_num;
+  const boost::mpi::communicator group_comm = world_.split(group);
+
+  SITPST direction;
+  if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+    direction = search_dir;
+  }
+  if (!optimize_para.replicated_update) {
+    BroadCast(direction, world_);
+  }
+  double e0_min = 0.0;
+  if (world_.rank() == kMasterProc) {
+    e0_min = std::real(energy_trajectory_[0]);
+  }
+  boost::mpi::broadcast(world_, e0_min, kMasterProc);
+  const SITPST tps_init = split_index_tps_;
+
+  // only the leaders of the groups fill the data of their strides, the others are left 0 for the reduction
+  std::vector<TenElemT> energies(strides.size(), TenElemT(0));
+  std::vector<double> en_errs(strides.size(), 0.0);
+  std::vector<double> ess_ratios(strides.size(), 0.0);
+  std::vector<int> evaluated(strides.size(), 0);
+  bool reweighting = optimize_para.line_search_reweighting && !chains_[0].config_samples.empty();
+  sampling_comm_ = group_comm;
+  size_t applied_num = 0; // number of the strides applied to split_index_tps_
+  for (size_t point = group; point < strides.size(); point += group_num) {
+    const auto point_start = std::chrono::steady_clock::now();
+    for (; applied_num <= point; applied_num++) {
+      split_index_tps_ += (-strides[applied_num]) * direction;
+      split_index_tps_.NormalizeAllSite();
+    }
+    TenElemT energy;
+    double en_err;
+    double ess_ratio = -1.0;
+    bool reweighted = false;
+    if (reweighting) {
+      std::tie(energy, en_err, ess_ratio) = ReweightedEnergy_();
+      reweighted = (ess_ratio >= optimize_para.reweighting_min_ess_ratio);
+      reweighting = reweighted;
+    }
+    if (!reweighted) {
+      RebuildChains_();
+      ClearEnergyAndHoleSamples_();
+      SampleChains_(false);
+      if (preempted_) {
+        break;
+      }
+      TenElemT en_self = Mean(energy_samples_); //energy value in each processor
+      std::tie(energy, en_err) = GatherStatisticSingleData(en_self, MPI_Comm(group_comm));
+    }
+    if (group_comm.rank() == kMasterProc) {
+      energies[point] = energy;
+      en_errs[point] = en_err;
+      ess_ratios[point] = ess_ratio;
+      evaluated[point] = 1;
+    }
+    // polled in the group only, since the groups evaluate the different numbers of strides
+    const double point_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - point_start).count();
+    if (point + group_num < strides.size() && PreemptionDue_(point_time, group_comm)) {
+      preempted_ = true;
+      break;
+    }
+  }
+  sampling_comm_ = world_;
+  preempted_ = boost::mpi::all_reduce(world_, preempted_, std::logical_or<bool>());
+  ::MPI_Allreduce(MPI_IN_PLACE, evaluated.data(), evaluated.size(), MPI_INT, MPI_SUM, MPI_Comm(world_));
+  MPI_Datatype data_type = MPIDataType<TenElemT>();
+  ::MPI_Allreduce(MPI_IN_PLACE, energies.data(), energies.size(), data_type, MPI_SUM, MPI_Comm(world_));
+  ::MPI_Allreduce(MPI_IN_PLACE, en_errs.data(), en_errs.size(), MPI_DOUBLE, MPI_SUM, MPI_Comm(world_));
+  ::MPI_Allreduce(MPI_IN_PLACE, ess_ratios.data(), ess_ratios.size(), MPI_DOUBLE, MPI_SUM, MPI_Comm(world_));
+
+  size_t best_num = 0; // number of the strides applied to get the TPS of the lowest energy
+  for (size_t point = 0; point < strides.size(); point++) {
+    if (evaluated[point] && std::real(energies[point]) < e0_min) {
+      e0_min = std::real(energies[point]);
+      best_num = point + 1;
+    }
+  }
+  split_index_tps_ = tps_init;
+  for (size_t point = 0; point < best_num; point++) {
+    split_index_tps_ += (-strides[point]) * direction;
+    split_index_tps_.NormalizeAllSite();
+  }
+  RebuildChains_();
+
+  if (world_.rank() == kMasterProc) {
+    for (size_t point = 0; point < strides.size(); point++) {
+      if (!evaluated[point]) {
+        std::cout << "Stride :" << std::setw(9) << strides[point] << "not evaluated because of the preemption.\n";
+        continue;
+      }
+      energy_trajectory_.push_back(energies[point]);
+      energy_error_traj_.push_back(en_errs[point]);
+      std::cout << "Stride :" << std::setw(9) << strides[point]
+                << "E0 = " << std::setw(14) << std::fixed << std::setprecision(kEnergyOutputPrecision)
+                << energies[point]
+                << pm_sign << " " << std::setw(10) << std::scientific << std::setprecision(2)
+                << en_errs[point];
+      if (ess_ratios[point] >= 0.0) {
+        std::cout << "ESS ratio = " << std::setw(5) << std::fixed << std::setprecision(2) << ess_ratios[point];
+      }
+      std::cout << "\n";
+    }
+    std::cout << "Line search in " << group_num << " groups, " << best_num << " strides taken,"
+              << " TotT = " << std::setw(8) << std::fixed << std::setprecision(2) << line_search_timer.Elapsed() << "s"
+              << std::endl;
+  }
 }
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::IterativeOptimizeTPS_(void) {
-  for (size_t iter = 0; iter < optimize_para.step_lens.size(); iter++) {
+  const size_t check_interval = optimize_para.replica_check_interval;
+  last_checkpoint_time_ = std::chrono::steady_clock::now();
+  for (size_t iter = start_iter_; iter < optimize_para.step_lens.size(); iter++) {
+    const auto iter_start = std::chrono::steady_clock::now();
     IterativeOptimizeTPSStep_(iter);
+    if (preempted_) {  // set by the sampling, iteration iter is not done
+      if (world_.rank() == kMasterProc) {
+        std::cout << "Stop the optimization during the sampling of iteration " << iter
+                  << " because of the preemption signal or the walltime budget." << std::endl;
+      }
+      if (iter > 0) {
+        DumpCheckpoint_(iter - 1);
+      }
+      break;
+    }
+    if (optimize_para.replicated_update && check_interval > 0 && (iter + 1) % check_interval == 0
+        && !CheckTPSReplicas()) {
+      if (world_.rank() == kMasterProc) {
+        std::cout << "warning: the TPS replicas differ after iteration " << iter
+                  << ", broadcast the TPS of master." << std::endl;
+      }
+      BroadCast(split_index_tps_, world_);
+      RebuildChains_();
+    }
+    const double iter_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - iter_start).count();
+    if (PreemptionDue_(iter_time)) {
+      if (world_.rank() == kMasterProc) {
+        std::cout << "Stop the optimization after iteration " << iter
+                  << " because of the preemption signal or the walltime budget." << std::endl;
+      }
+      DumpCheckpoint_(iter);
+      preempted_ = true;
+      break;
+    }
+    FitScheduleToWalltime_(iter, iter_time);
+    if (CheckpointDue_(iter)) {
+      DumpCheckpoint_(iter);
+    }
+  }
+}
+
+/**
+ * Collective, true if any processor receives the preemption signal,
+ * or the remaining walltime may be not enough for another step of step_time.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::PreemptionDue_(const double step_time) {
+  return PreemptionDue_(step_time, world_);
+}
+
+///< Collective in comm, as above with the processors of comm only.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::PreemptionDue_(
+    const double step_time, const boost::mpi::communicator &comm) {
+  // 1.5 leaves time for the fluctuation of the step time and the dumps
+  const bool stop = PreemptionSignalReceived() || walltime_.Remaining() < 1.5 * step_time;
+  return boost::mpi::all_reduce(comm, stop, std::logical_or<bool>());
+}
+
+///< whether the run may be preempted, i.e. the preemption signals are trapped or the walltime is limited
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::PreemptionPossible_(void) const {
+  return optimize_para.trap_preemption_signals || walltime_.Limited();
+}
+
+///< whether the O^*(S) samples are kept in gten_samples_, for stochastic reconfiguration and KrylovSubspaceSR
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::RecordOSamples_(void) const {
+  return stochastic_reconfiguration_update_class_ || optimize_para.update_scheme == KrylovSubspaceSR;
+}
+
+///< Keep the iterations which are affordable in the remaining walltime, with one iteration time for the final dump.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::FitScheduleToWalltime_(
+    const size_t iter, const double iter_time) {
+  if (!optimize_para.fit_schedule_to_walltime || !walltime_.Limited()) {
+    return;
+  }
+  size_t iter_num = optimize_para.step_lens.size();
+  if (world_.rank() == kMasterProc) {
+    const double remaining = walltime_.Remaining() - iter_time;
+    const size_t affordable = remaining > 0.0 ? size_t(remaining / iter_time) : 0;
+    iter_num = std::min(iter_num, iter + 1 + affordable);
+  }
+  boost::mpi::broadcast(world_, iter_num, kMasterProc);
+  if (iter_num < optimize_para.step_lens.size()) {
+    if (world_.rank() == kMasterProc) {
+      std::cout << "Shorten the schedule from " << optimize_para.step_lens.size() << " to " << iter_num
+                << " iterations to fit the walltime budget." << std::endl;
+    }
+    optimize_para.step_lens.resize(iter_num);
   }
 }
 
@@ -372,32 +629,43 @@ void VMCPEPSExecutor<TenElemT,
                      QNT,
                      EnergySolver,
                      WaveFunctionComponentType>::IterativeOptimizeTPSStep_(const size_t iter) {
-  std::vector<double> accept_rates_accum;
   ClearEnergyAndHoleSamples_();
 
   Timer grad_update_timer("gradient_update");
-  for (size_t sweep = 0; sweep < optimize_para.mc_samples; sweep++) {
-    std::vector<double> accept_rates = MCSweep_();
-    if (sweep == 0) {
-      accept_rates_accum = accept_rates;
-    } else {
-      for (size_t i = 0; i < accept_rates_accum.size(); i++) {
-        accept_rates_accum[i] += accept_rates[i];
+  std::vector<double> accept_rates_avg = SampleChains_(true);
+  if (preempted_) {
+    return; // the samples are incomplete, see IterativeOptimizeTPS_
+  }
+  const double bmps_sweeps = BMPSSweepsPerCompression_(); // before the chains are rebuilt by the update
+  GatherStatisticEnergyAndGrad_();
+
+  if (optimize_para.adaptive_step_len) {
+    if (AdaptStepLength_(iter)) {
+      RejectLastUpdate_();
+      if (world_.rank() == kMasterProc) {
+        std::cout << "Iter " << std::setw(4) << iter
+                  << "E0 = " << std::setw(14) << std::fixed << std::setprecision(kEnergyOutputPrecision)
+                  << energy_trajectory_.back()
+                  << pm_sign << " " << std::setw(10) << std::scientific << std::setprecision(2)
+                  << energy_error_traj_.back()
+                  << "rejected, restore the previous TPS and shrink Alpha to "
+                  << std::scientific << std::setprecision(1) << optimize_para.step_lens[iter]
+                  << " TotT = " << std::setw(8) << std::fixed << std::setprecision(2) << grad_update_timer.Elapsed()
+                  << "s\n";
       }
+      return;
+    }
+    if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+      tps_before_update_ = split_index_tps_;
+      optimizer_before_update_ = momentum_optimizer_;
     }
-    SampleEnergyAndHols_();
-  }
-  std::vector<double> accept_rates_avg = accept_rates_accum;
-  for (double &rates : accept_rates_avg) {
-    rates /= double(optimize_para.mc_samples);
   }
-  GatherStatisticEnergyAndGrad_();
 
   Timer tps_update_timer("tps_update");
   size_t sr_iter;
   double sr_natural_grad_norm;
   SITPST init_guess;
-  if (iter == 0) {
+  if (iter == 0 || natural_grad_({0, 0}).empty()) {
     init_guess = SITPST(ly_, lx_, split_index_tps_.PhysicalDim()); //set 0 as initial guess
   } else {
     init_guess = natural_grad_;
@@ -407,7 +675,7 @@ void VMCPEPSExecutor<TenElemT,
   switch (optimize_para.update_scheme) {
     case StochasticGradient:UpdateTPSByVecAndSynchronize_(grad_, step_len);
       break;
-    case RandomStepStochasticGradient:step_len *= unit_even_distribution(random_engine);
+    case RandomStepStochasticGradient:step_len *= rand_stream_.Uniform();
       UpdateTPSByVecAndSynchronize_(grad_, step_len);
       break;
     case StochasticReconfiguration: {
@@ -417,7 +685,13 @@ void VMCPEPSExecutor<TenElemT,
       break;
     }
     case RandomStepStochasticReconfiguration: {
-      step_len *= unit_even_distribution(random_engine);
+      step_len *= rand_stream_.Uniform();
+      auto iter_natural_grad_norm = StochReconfigUpdateTPS_(grad_, step_len, init_guess, false);
+      sr_iter = iter_natural_grad_norm.first;
+      sr_natural_grad_norm = iter_natural_grad_norm.second;
+      break;
+    }
+    case SampleSpaceStochasticReconfiguration: {
       auto iter_natural_grad_norm = StochReconfigUpdateTPS_(grad_, step_len, init_guess, false);
       sr_iter = iter_natural_grad_norm.first;
       sr_natural_grad_norm = iter_natural_grad_norm.second;
@@ -436,6 +710,35 @@ void VMCPEPSExecutor<TenElemT,
     }
     case BoundGradientElement:BoundGradElementUpdateTPS_(grad_, step_len);
       break;
+    case Momentum:
+    case NesterovMomentum: {
+      SITPST direction;
+      if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+        direction = momentum_optimizer_.MomentumDirection(grad_, optimize_para.momentum,
+                                                          optimize_para.update_scheme == NesterovMomentum);
+      }
+      UpdateTPSByVecAndSynchronize_(direction, step_len);
+      break;
+    }
+    case Adam: {
+      SITPST direction;
+      if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+        direction = momentum_optimizer_.AdamDirection(grad_, optimize_para.adam_beta1, optimize_para.adam_beta2,
+                                                      optimize_para.adam_epsilon);
+      }
+      UpdateTPSByVecAndSynchronize_(direction, step_len);
+      break;
+    }
+    case KrylovSubspaceSR: {
+      double predicted_energy;
+      if (!KrylovSubspaceSRUpdateTPS_(step_len, predicted_energy)) {
+        if (world_.rank() == kMasterProc) {
+          std::cout << "warning: the Krylov subspace SR fails, update along the gradient instead." << std::endl;
+        }
+        UpdateTPSByVecAndSynchronize_(grad_, step_len);
+      }
+      break;
+    }
     default:std::cout << "update method does not support!" << std::endl;
       exit(2);
   }
@@ -456,6 +759,12 @@ void VMCPEPSExecutor<TenElemT,
       std::cout << std::setw(5) << std::fixed << std::setprecision(2) << rate;
     }
     std::cout << "]";
+    if (AdaptiveSampling_()) {
+      std::cout << "Samples = " << std::setw(8) << sample_num_ * world_.size();
+    }
+    if (optimize_para.bmps_trunc_para.warm_start) {
+      std::cout << "BMPS sweeps = " << std::setw(5) << std::fixed << std::setprecision(2) << bmps_sweeps;
+    }
 
     if (stochastic_reconfiguration_update_class_) {
       std::cout << "SRSolver Iter = " << std::setw(4) << sr_iter;
@@ -467,6 +776,64 @@ void VMCPEPSExecutor<TenElemT,
   }
 }
 
+///< expand step_lens to the iteration number of the adaptive step length, and set the controller.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::InitStepLengthController_(void) {
+  if (!optimize_para.adaptive_step_len) {
+    return;
+  }
+  if (optimize_para.step_lens.empty()) {
+    std::cout << "The initial step length should be given by step_lens[0] for the adaptive step length."
+              << std::endl;
+    exit(1);
+  }
+  if (optimize_para.adaptive_iteration_num > 0) {
+    const double init_step_len = optimize_para.step_lens.front();
+    optimize_para.step_lens.assign(optimize_para.adaptive_iteration_num, init_step_len);
+  }
+  step_len_controller_ = StepLengthController(optimize_para.step_len_grow, optimize_para.step_len_shrink,
+                                              optimize_para.step_len_min, optimize_para.step_len_max,
+                                              optimize_para.step_reject_sigma);
+}
+
+/**
+ * Collective. Feed the energy and the gradient norm of this iteration to the controller in master,
+ * and set the step lengths of this and the later iterations to the adapted one.
+ * Return true if the last update should be rejected.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::AdaptStepLength_(const size_t iter) {
+  double step_len = optimize_para.step_lens[iter];
+  bool reject = false;
+  if (world_.rank() == kMasterProc) {
+    reject = step_len_controller_.Feed(std::real(energy_trajectory_.back()), std::real(energy_error_traj_.back()),
+                                       grad_norm_.back(), tps_before_update_.rows() > 0, step_len);
+  }
+  boost::mpi::broadcast(world_, step_len, kMasterProc);
+  boost::mpi::broadcast(world_, reject, kMasterProc);
+  std::fill(optimize_para.step_lens.begin() + iter, optimize_para.step_lens.end(), step_len);
+  return reject;
+}
+
+///< Collective. Restore the TPS and the optimizer state before the last update.
+///< The same update cannot be rejected twice.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::RejectLastUpdate_(void) {
+  std::vector<size_t> signature;
+  if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+    signature = DataSizeSignature(split_index_tps_);
+    split_index_tps_ = std::move(tps_before_update_);
+    momentum_optimizer_ = std::move(optimizer_before_update_);
+  }
+  tps_before_update_ = SITPST();
+  optimizer_before_update_ = MomentumOptimizer<TenElemT, QNT>();
+  if (optimize_para.replicated_update) {
+    RebuildChains_();
+  } else {
+    SynchronizeUpdatedTPS_(signature);
+  }
+}
+
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::ClearEnergyAndHoleSamples_(void) {
   energy_samples_.clear();
@@ -485,56 +852,322 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Cl
 //      }
 //    }
 //  }
+  ResetGradientAccumulators_();
+  if (RecordOSamples_()) {
+    // the zero accumulators give the full blocks layout
+    gten_samples_.Initialize(chains_[0].gten_sum, optimize_para.mc_samples);
+  }
+}
+
+/**
+ * Set the gradient accumulators of the chains (gten_sum, g_times_energy_sum and their block sums)
+ * to zero tensors with full blocks, so that the data layouts of the gradients are the same in all the processors
+ * and can be reduced in one buffer (see MPIMeanSplitIndexTPS).
+ *
+ * The accumulators are allocated only at the first time, and set to zero in place afterward.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::ResetGradientAccumulators_(void) {
+  for (MarkovChain &chain : chains_) {
+    for (size_t row = 0; row < ly_; row++) {
+      for (size_t col = 0; col < lx_; col++) {
+        const size_t dim = split_index_tps_.PhysicalDim({row, col});
+        for (SITPST *acc : {&chain.gten_sum, &chain.g_times_energy_sum,
+                            &chain.gten_block_sum, &chain.g_times_energy_block_sum}) {
+          if ((*acc)({row, col}).size() != dim) {
+            (*acc)({row, col}) = std::vector<Tensor>(dim);
+          }
+          for (size_t compt = 0; compt < dim; compt++) {
+            const Tensor &ten = split_index_tps_({row, col})[compt];
+            Tensor &acc_ten = (*acc)({row, col})[compt];
+            if (!acc_ten.IsDefault() && acc_ten.GetIndexes() == ten.GetIndexes() && acc_ten.Div() == ten.Div()) {
+              acc_ten *= TenElemT(0);
+            } else {
+              acc_ten = Tensor(ten.GetIndexes());
+              acc_ten.Fill(ten.Div(), TenElemT(0));
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Add the block sums of the chain into its gten_sum and g_times_energy_sum, and set the block sums to zero.
+ *
+ * The samples are summed in blocks with ~sqrt(mc_samples) samples to avoid adding the small numbers
+ * of one sample directly to the large accumulated sums.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::FlushGradientBlockSum_(
+    MarkovChain &chain) {
   for (size_t row = 0; row < ly_; row++) {
     for (size_t col = 0; col < lx_; col++) {
-      size_t dim = split_index_tps_.PhysicalDim({row, col});
-      gten_sum_({row, col}) = std::vector<Tensor>(dim, Tensor(split_index_tps_({row, col})[0].GetIndexes()));
-      g_times_energy_sum_({row, col}) = gten_sum_({row, col});
+      const size_t dim = split_index_tps_.PhysicalDim({row, col});
+      for (size_t compt = 0; compt < dim; compt++) {
+        chain.gten_sum({row, col})[compt] += chain.gten_block_sum({row, col})[compt];
+        chain.g_times_energy_sum({row, col})[compt] += chain.g_times_energy_block_sum({row, col})[compt];
+        chain.gten_block_sum({row, col})[compt] *= TenElemT(0);
+        chain.g_times_energy_block_sum({row, col})[compt] *= TenElemT(0);
+      }
     }
   }
-  if (stochastic_reconfiguration_update_class_) {
-    gten_samples_.clear();
+}
+
+/**
+ * Determine the seed, which is drawn by master if not given, and seed the stream of this processor.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::InitRandomStreams_(void) {
+  random_seed_ = optimize_para.random_seed;
+  if (random_seed_ == 0) {
+    if (world_.rank() == kMasterProc) {
+      random_seed_ = RandomDeviceSeed();
+    }
+    boost::mpi::broadcast(world_, random_seed_, kMasterProc);
+  }
+  // the replicated update needs the same random step lengths in all the processors
+  const uint32_t stream_rank = optimize_para.replicated_update ? 0 : world_.rank();
+  rand_stream_.Seed(random_seed_, stream_rank, kProcessorStreamId);
+}
+
+/**
+ * Create the Markov chains in this processor from the configuration, and seed their random streams.
+ * The chains start from the same configuration and are decorrelated by the warm up.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::InitChains_(
+    const Configuration &config) {
+  const size_t chain_num = std::max<size_t>(1, optimize_para.chains_per_proc);
+  chains_.clear();
+  chains_.reserve(chain_num);
+  for (size_t c = 0; c < chain_num; c++) {
+    chains_.emplace_back(ly_, lx_, energy_solver_);
+    chains_[c].rand_stream.Seed(random_seed_, world_.rank(), c);
+  }
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+  for (size_t c = 0; c < chain_num; c++) {
+    chains_[c].tps_sample = WaveFunctionComponentType(split_index_tps_, config);
+  }
+}
+
+/**
+ * Sample mc_samples samples in this processor, distributed over the chains which run in parallel threads.
+ * Each chain keeps its own energy samples and gradient accumulators, which are merged into
+ * energy_samples_ (and gten_sum_, g_times_energy_sum_ if calc_holes) in the order of the chains.
+ * For stochastic reconfiguration and the Krylov subspace SR, the rows of gten_samples_ are allocated in advance
+ * so that the chains write to different rows.
+ *
+ * With the adaptive sampling, the samples are drawn in blocks, and the sampling stops once the error targets
+ * are reached (see SamplingConverged_). All the processors draw the same number of samples.
+ *
+ * If record_configs, the configurations and amplitudes of the samples are kept in the chains for ReweightedEnergy_.
+ *
+ * If the run may be preempted, the samples are also drawn in blocks (of preemption_poll_samples samples), and the
+ * preemption is polled in sampling_comm_ after each block. Then the sampling stops early with preempted_ set,
+ * and the callers should drop the incomplete samples.
+ *
+ * @return the average accept rates
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+std::vector<double> VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleChains_(
+    const bool calc_holes, const bool record_configs) {
+  const size_t chain_num = chains_.size();
+  const size_t max_sample_num = optimize_para.mc_samples;
+  const bool adaptive = AdaptiveSampling_();
+  const bool poll_preemption = PreemptionPossible_();
+  size_t block_size = max_sample_num;
+  if (adaptive) {
+    block_size = optimize_para.adaptive_sample_block > 0 ? optimize_para.adaptive_sample_block
+                                                         : std::max<size_t>(1, max_sample_num / 10);
+  }
+  if (poll_preemption) {
+    const size_t poll_size = optimize_para.preemption_poll_samples > 0 ? optimize_para.preemption_poll_samples
+                                                                       : std::max<size_t>(1, max_sample_num / 10);
+    block_size = std::min(block_size, poll_size);
+  }
+  for (MarkovChain &chain : chains_) {
+    chain.energy_samples.clear();
+    chain.accept_rates_accum.clear();
+    chain.moments = SampleMoments();
+    chain.config_samples.clear();
+    chain.amplitude_samples.clear();
+  }
+  energy_samples_.clear();
+  const bool record_o_samples = calc_holes && RecordOSamples_();
+
+  size_t sample_num = 0;
+  while (sample_num < max_sample_num) {
+    const auto block_start = std::chrono::steady_clock::now();
+    const size_t block_sample_num = std::min(block_size, max_sample_num - sample_num);
+    size_t offset = sample_num;
+    for (size_t c = 0; c < chain_num; c++) {
+      MarkovChain &chain = chains_[c];
+      chain.sample_num = block_sample_num / chain_num + (c < block_sample_num % chain_num ? 1 : 0);
+      chain.sample_offset = offset;
+      offset += chain.sample_num;
+    }
+    if (record_o_samples) {
+      for (size_t i = 0; i < block_sample_num; i++) {
+        gten_samples_.AppendSample();
+      }
+    }
+    SampleChainsBlock_(calc_holes, record_configs);
+    for (MarkovChain &chain : chains_) {
+      energy_samples_.insert(energy_samples_.end(), chain.energy_samples.cend() - chain.sample_num,
+                             chain.energy_samples.cend());
+    }
+    sample_num += block_sample_num;
+    const double block_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - block_start).count();
+    if (poll_preemption && sample_num < max_sample_num && PreemptionDue_(block_time, sampling_comm_)) {
+      preempted_ = true;
+      break;
+    }
+    if (adaptive && sample_num < max_sample_num && sample_num >= optimize_para.adaptive_min_samples
+        && SamplingConverged_(calc_holes)) {
+      break;
+    }
+  }
+  sample_num_ = sample_num;
+
+  std::vector<double> accept_rates_avg;
+  for (MarkovChain &chain : chains_) {
+    if (accept_rates_avg.empty()) {
+      accept_rates_avg.assign(chain.accept_rates_accum.size(), 0.0);
+    }
+    for (size_t i = 0; i < chain.accept_rates_accum.size(); i++) {
+      accept_rates_avg[i] += chain.accept_rates_accum[i];
+    }
+  }
+  for (double &rates : accept_rates_avg) {
+    rates /= double(sample_num);
+  }
+  if (calc_holes) {
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+    for (size_t c = 0; c < chain_num; c++) {
+      FlushGradientBlockSum_(chains_[c]);
+    }
+    // the zero accumulators of the first chain are swapped out, and reset in the next sampling.
+    std::swap(gten_sum_, chains_[0].gten_sum);
+    std::swap(g_times_energy_sum_, chains_[0].g_times_energy_sum);
+    for (size_t c = 1; c < chain_num; c++) {
+      gten_sum_ += chains_[c].gten_sum;
+      g_times_energy_sum_ += chains_[c].g_times_energy_sum;
+    }
   }
+  return accept_rates_avg;
 }
 
+///< sample chain.sample_num samples in each chain, and append them to the data of the chains
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
-void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleEnergyAndHols_(void) {
-  TensorNetwork2D<TenElemT, QNT> holes(ly_, lx_);
-  TenElemT energy_loc = energy_solver_.template CalEnergyAndHoles<WaveFunctionComponentType, true>(&split_index_tps_,
-                                                                                                   &tps_sample_,
-                                                                                                   holes);
-  TenElemT inv_psi = 1.0 / tps_sample_.amplitude;
-  energy_samples_.push_back(energy_loc);
-  SITPST gten_sample(ly_, lx_, split_index_tps_.PhysicalDim());// only useful for Stochastic Reconfiguration
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleChainsBlock_(
+    const bool calc_holes, const bool record_configs) {
+  const size_t chain_num = chains_.size();
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+  for (size_t c = 0; c < chain_num; c++) {
+    MarkovChain &chain = chains_[c];
+    for (size_t sweep = 0; sweep < chain.sample_num; sweep++) {
+      std::vector<double> accept_rates = MCSweep_(chain);
+      if (chain.accept_rates_accum.empty()) {
+        chain.accept_rates_accum = accept_rates;
+      } else {
+        for (size_t i = 0; i < chain.accept_rates_accum.size(); i++) {
+          chain.accept_rates_accum[i] += accept_rates[i];
+        }
+      }
+      if (record_configs) {
+        chain.config_samples.push_back(chain.tps_sample.config);
+        chain.amplitude_samples.push_back(chain.tps_sample.amplitude);
+      }
+      if (calc_holes) {
+        SampleEnergyAndHols_(chain, chain.sample_offset + sweep);
+      } else {
+        SampleEnergy_(chain);
+      }
+    }
+  }
+}
+
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::AdaptiveSampling_(void) const {
+  return optimize_para.energy_target_relative_error > 0.0 || optimize_para.grad_target_relative_error > 0.0;
+}
+
+///< average sweep number of the variational boundary MPS compressions in the chains of this processor since the last
+///< call, to monitor the warm start of the compressions (BMPSTruncatePara::warm_start).
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+double VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::BMPSSweepsPerCompression_(void) {
+  BMPSCompressStatistics stat;
+  for (MarkovChain &chain : chains_) {
+    stat += chain.tps_sample.tn.GetBMPSCompressStatistics();
+    chain.tps_sample.tn.ClearBMPSCompressStatistics();
+  }
+  return stat.compress_num > 0 ? double(stat.sweep_num) / double(stat.compress_num) : 0.0;
+}
+
+/**
+ * Collective. Decide whether the samples drawn so far reach the error targets, see SamplingConverged.
+ *
+ * The autocorrelation is neglected, which is reasonable with enough sweeps between the samples.
+ * The gradient target is not checked in the energy only samplings (the line search).
+ * The samples are shared in sampling_comm_.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SamplingConverged_(
+    const bool calc_holes) {
+  SampleMoments moments;
+  for (const MarkovChain &chain : chains_) {
+    moments += chain.moments;
+  }
+  const double grad_norm_sqr = grad_norm_.empty() ? 0.0 : grad_norm_.back();
+  return SamplingConverged(moments, optimize_para.energy_target_relative_error,
+                           optimize_para.grad_target_relative_error, grad_norm_sqr, calc_holes, sampling_comm_);
+}
+
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleEnergyAndHols_(
+    MarkovChain &chain, const size_t sample_idx) {
+  TenElemT energy_loc = chain.energy_solver.template CalEnergyAndHoles<WaveFunctionComponentType, true>(
+      &split_index_tps_, &chain.tps_sample, chain.holes);
+  TenElemT inv_psi = 1.0 / chain.tps_sample.amplitude;
+  chain.energy_samples.push_back(energy_loc);
+  const bool adaptive = AdaptiveSampling_();
+  double o_norm_sqr = 0.0;
   for (size_t row = 0; row < ly_; row++) {
     for (size_t col = 0; col < lx_; col++) {
-      size_t basis = tps_sample_.config({row, col});
-//      Tensor *g_ten = new Tensor(), *gten_times_energy = new Tensor();
-//      *g_ten = inv_psi * holes({row, col});
-//      *gten_times_energy = energy_loc * (*g_ten);
-//      gten_samples_({row, col})[basis].push_back(g_ten);
-//      g_times_energy_samples_({row, col})[basis].push_back(gten_times_energy);
-      Tensor gten = inv_psi * holes({row, col});
-      gten_sum_({row, col})[basis] += gten;
-      g_times_energy_sum_({row, col})[basis] += energy_loc * gten;
-      //? when samples become large, does the summation reliable as the small number are added to large number.
-      if (stochastic_reconfiguration_update_class_) {
-        gten_sample({row, col})[basis] = gten;
+      size_t basis = chain.tps_sample.config({row, col});
+      // the holes are overwritten in the next sample, so they are rescaled in place to O^*(S) and O^*(S) * E_loc(S),
+      // and added into the block sums which have the full blocks and need no reallocation.
+      Tensor &gten = chain.holes({row, col});
+      gten *= inv_psi;
+      if (adaptive) {
+        const double norm = gten.Get2Norm();
+        o_norm_sqr += norm * norm;
       }
+      chain.gten_block_sum({row, col})[basis] += gten;
+      if (RecordOSamples_()) {
+        gten_samples_.SetSiteData(sample_idx, {row, col}, basis, gten);
+      }
+      gten *= energy_loc;
+      chain.g_times_energy_block_sum({row, col})[basis] += gten;
     }
   }
-  if (stochastic_reconfiguration_update_class_) {
-    gten_samples_.emplace_back(gten_sample);
+  if (adaptive) {
+    chain.moments.Add(energy_loc, o_norm_sqr);
+  }
+  if (chain.energy_samples.size() % accumulate_block_size_ == 0) {
+    FlushGradientBlockSum_(chain);
   }
 }
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
-TenElemT VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleEnergy_(void) {
+TenElemT VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SampleEnergy_(MarkovChain &chain) {
   TensorNetwork2D<TenElemT, QNT> holes(1, 1); //useless
-  TenElemT energy_loc = energy_solver_.template CalEnergyAndHoles<WaveFunctionComponentType, false>(&split_index_tps_,
-                                                                                                    &tps_sample_,
-                                                                                                    holes);
-  energy_samples_.push_back(energy_loc);
+  TenElemT energy_loc = chain.energy_solver.template CalEnergyAndHoles<WaveFunctionComponentType, false>(
+      &split_index_tps_, &chain.tps_sample, holes);
+  chain.energy_samples.push_back(energy_loc);
+  chain.moments.Add(energy_loc, 0.0);
   return energy_loc;
 }
 
@@ -550,7 +1183,7 @@ VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::GatherS
   }
 
   //calculate grad in each processor
-  const size_t sample_num = optimize_para.mc_samples;
+  const size_t sample_num = energy_samples_.size();
   gten_ave_ = gten_sum_ * (1.0 / sample_num);
   for (size_t row = 0; row < ly_; row++) {
     for (size_t col = 0; col < lx_; col++) {
@@ -568,19 +1201,18 @@ VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::GatherS
       }
     }
   }
-  for (size_t row = 0; row < ly_; row++) {
-    for (size_t col = 0; col < lx_; col++) {
-      const size_t phy_dim = grad_({row, col}).size();
-      for (size_t compt = 0; compt < phy_dim; compt++) {
-        // gather and estimate grad in master (and maybe the error bar of grad)
-        grad_({row, col})[compt] = MPIMeanTensor(grad_({row, col})[compt], world_);
-        // note here the grad data except in master are clear
-        if (stochastic_reconfiguration_update_class_) {
-          gten_ave_({row, col})[compt] = MPIMeanTensor(gten_ave_({row, col})[compt], world_);
-        }
-      }
-    }
+  // gather and estimate grad in master (and maybe the error bar of grad) by one reduction.
+  // if grad_all_reduce is false, the grad data except in master are only the local data.
+  std::vector<SITPST *> reduce_list = {&grad_};
+  if (RecordOSamples_()) {
+    reduce_list.push_back(&gten_ave_);
   }
+  // the sample space SR needs gten_ave_ in all the processors, and the AllReduce CG needs grad in all the processors.
+  const bool all_reduce = optimize_para.grad_all_reduce || optimize_para.replicated_update
+      || optimize_para.update_scheme == SampleSpaceStochasticReconfiguration
+      || optimize_para.update_scheme == KrylovSubspaceSR
+      || (stochastic_reconfiguration_update_class_ && CGParallelScheme_() != MasterSlaveCG);
+  MPIMeanSplitIndexTPS(reduce_list, world_, all_reduce);
   if (world_.rank() == kMasterProc) {
     grad_norm_.push_back(grad_.NormSquare());
   }
@@ -588,6 +1220,181 @@ VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::GatherS
   return grad_;
 }
 
+/**
+ * Update the TPS by the Krylov subspace SR (see KrylovSRSubspace) in the Krylov subspace {g, S g, S^2 g, ...}
+ * of dimension krylov_sr_dim, where g is the gradient and S the S matrix of stochastic reconfiguration.
+ * The subspace matrices are built from the O^*(S) samples in gten_samples_ and the local energies
+ * of the sampling, with no other local energy evaluation. It needs the gradient in all the processors.
+ *
+ * Collective.
+ * @return false if the Krylov subspace SR fails, in which case the TPS is unchanged.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::KrylovSubspaceSRUpdateTPS_(
+    double step_len, double &predicted_energy) {
+  SITPST update;
+  if (!KrylovSubspaceSRUpdate_(update, predicted_energy)) {
+    return false;
+  }
+  // T <- T + step_len * update
+  UpdateTPSByVecAndSynchronize_(update, -step_len);
+  if (world_.rank() == kMasterProc) {
+    std::cout << "Krylov subspace SR predicted E0 = " << std::fixed << std::setprecision(kEnergyOutputPrecision)
+              << predicted_energy << std::endl;
+  }
+  return true;
+}
+
+/**
+ * The parameter change of the Krylov subspace SR, see KrylovSubspaceSRUpdateTPS_. The Krylov vectors are
+ * orthonormalized, which only improves the conditioning of the subspace matrices.
+ *
+ * Collective, the update is given in all the processors.
+ * @return false if the Krylov subspace SR fails.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::KrylovSubspaceSRUpdate_(
+    SITPST &update, double &predicted_energy) {
+  const size_t local_num = gten_samples_.SampleNum();
+  if (local_num == 0 || local_num != energy_samples_.size() || optimize_para.krylov_sr_dim == 0) {
+    return false;
+  }
+  std::vector<TenElemT> ave_flat, v;
+  gten_samples_.Flatten(gten_ave_, ave_flat);
+  gten_samples_.Flatten(grad_, v);
+  auto norm = [](const std::vector<TenElemT> &vec) {
+    double norm_sqr = 0.0;
+    for (const TenElemT &elem : vec) {
+      norm_sqr += std::norm(elem);
+    }
+    return std::sqrt(norm_sqr);
+  };
+  const double grad_norm = norm(v);
+  if (!(grad_norm > 0.0) || !std::isfinite(grad_norm)) {
+    return false;
+  }
+  for (TenElemT &elem : v) {
+    elem *= 1.0 / grad_norm;
+  }
+  // the same directions in all the processors, since the gradient and <O^*> are all reduced.
+  std::vector<std::vector<TenElemT>> directions = {v};
+  while (directions.size() < optimize_para.krylov_sr_dim) {
+    std::vector<TenElemT> w = ApplySMatrix_(directions.back(), ave_flat);
+    const double w_norm = norm(w);
+    // the Gram-Schmidt twice against the round-off
+    for (size_t pass = 0; pass < 2; pass++) {
+      for (const auto &u : directions) {
+        TenElemT overlap(0);
+        for (size_t i = 0; i < w.size(); i++) {
+          overlap += ConjugateElem(u[i]) * w[i];
+        }
+        for (size_t i = 0; i < w.size(); i++) {
+          w[i] -= overlap * u[i];
+        }
+      }
+    }
+    const double residual_norm = norm(w);
+    if (!(residual_norm > 1e-10 * w_norm)) {
+      break;  // the Krylov subspace is invariant
+    }
+    for (TenElemT &elem : w) {
+      elem *= 1.0 / residual_norm;
+    }
+    directions.push_back(std::move(w));
+  }
+  const size_t n = directions.size();
+
+  // x_l(S_i) = O_i^dag v_l
+  std::vector<std::vector<TenElemT>> xs(n);
+  for (size_t l = 0; l < n; l++) {
+    gten_samples_.ConjMultiply(directions[l], xs[l]);
+  }
+  KrylovSRSubspace<TenElemT> subspace(n);
+  std::vector<TenElemT> x(n);
+  for (size_t i = 0; i < local_num; i++) {
+    for (size_t l = 0; l < n; l++) {
+      x[l] = xs[l][i];
+    }
+    subspace.AddSample(energy_samples_[i], x);
+  }
+  std::vector<TenElemT> &sums = subspace.Sums();
+  ::MPI_Allreduce(MPI_IN_PLACE, sums.data(), sums.size(), MPIDataType<TenElemT>(), MPI_SUM, MPI_Comm(world_));
+
+  // every processor solves the same reduced problem, the agreement is made sure against the round-off.
+  std::vector<TenElemT> param_change;
+  int solved = subspace.Solve(optimize_para.krylov_sr_shift, optimize_para.krylov_sr_xi,
+                              param_change, predicted_energy);
+  ::MPI_Allreduce(MPI_IN_PLACE, &solved, 1, MPI_INT, MPI_LAND, MPI_Comm(world_));
+  if (!solved) {
+    return false;
+  }
+  std::vector<TenElemT> update_flat(ave_flat.size(), TenElemT(0));
+  for (size_t l = 0; l < n; l++) {
+    for (size_t i = 0; i < update_flat.size(); i++) {
+      update_flat[i] += param_change[l] * directions[l][i];
+    }
+  }
+  update = gten_samples_.Unflatten(update_flat);
+  if (world_.rank() == kMasterProc) {
+    std::cout << "Krylov subspace SR dimension = " << n << std::endl;
+  }
+  return true;
+}
+
+/**
+ * S v = <O^* O^T> v - <O^*> (<O^*>^dag v) with the samples in all the processors, in the flattened parameters.
+ * Collective, the result is given in all the processors.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+std::vector<TenElemT> VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::ApplySMatrix_(
+    const std::vector<TenElemT> &v_flat, const std::vector<TenElemT> &ave_flat) {
+  std::vector<TenElemT> res;
+  gten_samples_.MultiplyOOdag(v_flat, res);
+  ::MPI_Allreduce(MPI_IN_PLACE, res.data(), res.size(), MPIDataType<TenElemT>(), MPI_SUM, MPI_Comm(world_));
+  const double total_num = double(gten_samples_.SampleNum() * world_.size());
+  TenElemT ave_v(0);
+  for (size_t i = 0; i < v_flat.size(); i++) {
+    ave_v += ConjugateElem(ave_flat[i]) * v_flat[i];
+  }
+  for (size_t i = 0; i < res.size(); i++) {
+    res[i] = res[i] / total_num - ave_flat[i] * ave_v;
+  }
+  return res;
+}
+
+/**
+ * Correlated sampling estimate of the energy of the current TPS, by reweighting the configurations recorded
+ * in the sampling of the original TPS with w = |psi_new / psi_old|^2:
+ *      E = sum_i w_i E_loc(S_i) / sum_i w_i.
+ * Only the amplitudes and the local energies of the recorded configurations are evaluated, no Monte-Carlo sweep.
+ * Collective in sampling_comm_, the results are available in all the processors of it.
+ *
+ * @return energy, its standard error, and the effective sample size ratio (sum_i w_i)^2 / (N sum_i w_i^2)
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+std::tuple<TenElemT, double, double>
+VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::ReweightedEnergy_(void) {
+  const size_t chain_num = chains_.size();
+  std::vector<ReweightingSums<TenElemT>> chain_sums(chain_num);
+#pragma omp parallel for num_threads(chain_num) schedule(static, 1) if(chain_num > 1)
+  for (size_t c = 0; c < chain_num; c++) {
+    MarkovChain &chain = chains_[c];
+    TensorNetwork2D<TenElemT, QNT> holes(1, 1); //useless
+    for (size_t i = 0; i < chain.config_samples.size(); i++) {
+      WaveFunctionComponentType tps_sample(split_index_tps_, chain.config_samples[i]);
+      const TenElemT energy_loc = chain.energy_solver.template CalEnergyAndHoles<WaveFunctionComponentType, false>(
+          &split_index_tps_, &tps_sample, holes);
+      chain_sums[c].Add(std::norm(tps_sample.amplitude / chain.amplitude_samples[i]), energy_loc);
+    }
+  }
+  ReweightingSums<TenElemT> sums;
+  for (size_t c = 0; c < chain_num; c++) {
+    sums += chain_sums[c];
+  }
+  sums.AllReduce(sampling_comm_);
+  return sums.Estimate();
+}
+
 /**
  * Stochastic gradient descent update peps
  *
@@ -603,13 +1410,23 @@ void VMCPEPSExecutor<TenElemT,
                      QNT,
                      EnergySolver,
                      WaveFunctionComponentType>::UpdateTPSByVecAndSynchronize_(const VMCPEPSExecutor::SITPST &grad,
-                                                                               double step_len) {
+                                                                               double step_len,
+                                                                               const bool rebuild_chains) {
+  if (optimize_para.replicated_update) {
+    split_index_tps_ += (-step_len) * grad;
+    split_index_tps_.NormalizeAllSite();
+    if (rebuild_chains) {
+      RebuildChains_();
+    }
+    return;
+  }
+  std::vector<size_t> signature;
   if (world_.rank() == kMasterProc) {
+    signature = DataSizeSignature(split_index_tps_);
     split_index_tps_ += (-step_len) * grad;
     split_index_tps_.NormalizeAllSite();
   }
-  BroadCast(split_index_tps_, world_);
-  tps_sample_ = WaveFunctionComponentType(split_index_tps_, tps_sample_.config);
+  SynchronizeUpdatedTPS_(signature, rebuild_chains);
 }
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
@@ -618,7 +1435,10 @@ void VMCPEPSExecutor<TenElemT,
                      EnergySolver,
                      WaveFunctionComponentType>::BoundGradElementUpdateTPS_(VMCPEPSExecutor::SITPST &grad,
                                                                             double step_len) {
-  if (world_.rank() == kMasterProc) {
+  const bool replicated = optimize_para.replicated_update;
+  std::vector<size_t> signature;
+  if (world_.rank() == kMasterProc || replicated) {
+    signature = DataSizeSignature(split_index_tps_);
     for (size_t row = 0; row < ly_; row++)
       for (size_t col = 0; col < lx_; col++) {
         const size_t phy_dim = grad_({row, col}).size();
@@ -632,21 +1452,72 @@ void VMCPEPSExecutor<TenElemT,
         double inv_norm = 1.0 / norm;
         for (size_t compt = 0; compt < phy_dim; compt++) {
           split_index_tps_({row, col})[compt] *= inv_norm;
-          SendBroadCastGQTensor(world_, split_index_tps_({row, col})[compt], kMasterProc);
         }
       }
+  }
+  if (replicated) {
+    RebuildChains_();
   } else {
-    for (size_t row = 0; row < ly_; row++)
-      for (size_t col = 0; col < lx_; col++) {
-        const size_t phy_dim = grad_({row, col}).size();
-        for (size_t compt = 0; compt < phy_dim; compt++) {
-          split_index_tps_({row, col})[compt] = Tensor();
-          RecvBroadCastGQTensor(world_, split_index_tps_({row, col})[compt], kMasterProc);
-        }
-      }
+    SynchronizeUpdatedTPS_(signature);
   }
 }
 
+/**
+ * Send the TPS updated in master to the other processors, and rebuild the chains on the new TPS.
+ * If the update keeps the block structures, which is the usual case except the first update,
+ * only the raw data are broadcast in one packed buffer; otherwise the tensors are broadcast one by one.
+ *
+ * @param signature_before_update  the DataSizeSignature of the TPS before the update, only used in master
+ * @param rebuild_chains  false if the chains are not sampled on the new TPS, e.g. in the reweighted line search
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT,
+                     QNT,
+                     EnergySolver,
+                     WaveFunctionComponentType>::SynchronizeUpdatedTPS_(
+    const std::vector<size_t> &signature_before_update, const bool rebuild_chains) {
+  bool structure_kept = false;
+  if (world_.rank() == kMasterProc) {
+    structure_kept = (signature_before_update == DataSizeSignature(split_index_tps_));
+  }
+  boost::mpi::broadcast(world_, structure_kept, kMasterProc);
+  if (structure_kept) {
+    BroadCastSplitIndexTPSData(split_index_tps_, world_);
+  } else {
+    BroadCast(split_index_tps_, world_);
+  }
+  if (rebuild_chains) {
+    RebuildChains_();
+  }
+}
+
+///< rebuild the wave function components of the chains on the current TPS
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::RebuildChains_(void) {
+#pragma omp parallel for num_threads(chains_.size()) schedule(static, 1) if(chains_.size() > 1)
+  for (size_t c = 0; c < chains_.size(); c++) {
+    chains_[c].tps_sample = WaveFunctionComponentType(split_index_tps_, chains_[c].tps_sample.config);
+  }
+}
+
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::CheckTPSReplicas(void) {
+  unsigned long long checksum = SplitIndexTPSChecksum(split_index_tps_), min_checksum, max_checksum;
+  ::MPI_Allreduce(&checksum, &min_checksum, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, MPI_Comm(world_));
+  ::MPI_Allreduce(&checksum, &max_checksum, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_Comm(world_));
+  return min_checksum == max_checksum;
+}
+
+///< the replicated update needs the natural gradient in all the processors
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+ConjugateGradientParallelScheme
+VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::CGParallelScheme_(void) const {
+  if (optimize_para.replicated_update && cg_params.parallel_scheme == MasterSlaveCG) {
+    return AllReduceCG;
+  }
+  return cg_params.parallel_scheme;
+}
+
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 std::pair<size_t, double> VMCPEPSExecutor<TenElemT,
                                           QNT,
@@ -667,6 +1538,9 @@ template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFu
 size_t VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::CalcNaturalGradient_(
     const VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::SITPST &grad,
     const SITPST &init_guess) {
+  if (optimize_para.update_scheme == SampleSpaceStochasticReconfiguration) {
+    return CalcNaturalGradientInSampleSpace_(grad);
+  }
   SITPST *pgten_ave_(nullptr);
   if (world_.rank() == kMasterProc) {
     pgten_ave_ = &gten_ave_;
@@ -674,29 +1548,162 @@ size_t VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::
   SRSMatrix s_matrix(&gten_samples_, pgten_ave_, world_.size());
   s_matrix.diag_shift = cg_params.diag_shift;
   size_t cgsolver_iter;
-  natural_grad_ = ConjugateGradientSolver(s_matrix, grad, init_guess,
-                                          cg_params.max_iter, cg_params.tolerance,
-                                          cg_params.residue_restart_step, cgsolver_iter, world_);
+  const ConjugateGradientParallelScheme parallel_scheme = CGParallelScheme_();
+  auto solve = [&](const auto &precond) {
+    switch (parallel_scheme) {
+      case MasterSlaveCG: {
+        natural_grad_ = ConjugateGradientSolver(s_matrix, grad, init_guess,
+                                                cg_params.max_iter, cg_params.tolerance,
+                                                cg_params.residue_restart_step, cgsolver_iter, world_, precond);
+        break;
+      }
+      case AllReduceCG: {
+        natural_grad_ = ConjugateGradientSolverAllReduce(s_matrix, grad, init_guess,
+                                                         cg_params.max_iter, cg_params.tolerance,
+                                                         cg_params.residue_restart_step, cgsolver_iter, world_,
+                                                         precond);
+        break;
+      }
+    }
+  };
+  if (cg_params.preconditioner == NoPreconditioner) {
+    solve(IdentityPreconditioner());
+  } else {
+    SRPreconditioner<TenElemT, QNT> precond(cg_params.preconditioner, &gten_samples_, &gten_ave_,
+                                            cg_params.diag_shift, world_,
+                                            parallel_scheme != MasterSlaveCG, cg_params.precond_max_block_size);
+    solve(precond);
+  }
   return cgsolver_iter;
 }
 
+/**
+ * Natural gradient solved in the sample space (minSR).
+ *
+ * Denote the centered samples as the columns a_i = (O^*(S_i) - <O^*>) / sqrt(N) of the matrix A,
+ * and e_i = (E_loc(S_i) - E) / sqrt(N), where N is the total sample number in all processors.
+ * Then S = A A^dag and the gradient g = A e, so the natural gradient
+ *      (S + shift)^(-1) g = A (T + shift)^(-1) e,   T = A^dag A,
+ * where T is only a N x N matrix. T is built from the Gram matrix of the samples in all the processors,
+ * and the linear equation is solved by the Cholesky decomposition in every processor.
+ *
+ * If T or e is not finite, or T + shift is still not positive definite after optimize_para.max_shift_retry
+ * enlargements of the shift, the plain gradient is used as the natural gradient.
+ *
+ * @return 1, the dense solve counts as one iteration; 0 if falls back to the plain gradient.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+size_t VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::CalcNaturalGradientInSampleSpace_(
+    const SITPST &grad) {
+  const size_t local_num = gten_samples_.SampleNum();
+  const size_t world_size = world_.size();
+  const size_t total_num = local_num * world_size;
+  MPI_Datatype data_type = MPIDataType<TenElemT>();
+
+  std::vector<TenElemT> energies(total_num);
+  ::MPI_Allgather(energy_samples_.data(), local_num, data_type,
+                  energies.data(), local_num, data_type, MPI_Comm(world_));
+  const TenElemT energy = std::accumulate(energies.begin(), energies.end(), TenElemT(0)) / double(total_num);
+
+  // u_i = O_i^dag <O^*>
+  std::vector<TenElemT> ave_flat, u_local, u(total_num);
+  gten_samples_.Flatten(gten_ave_, ave_flat);
+  gten_samples_.ConjMultiply(ave_flat, u_local);
+  ::MPI_Allgather(u_local.data(), local_num, data_type, u.data(), local_num, data_type, MPI_Comm(world_));
+  TenElemT ave_norm_sqr(0);
+  for (const TenElemT &elem : ave_flat) {
+    ave_norm_sqr += ConjugateElem(elem) * elem;
+  }
+
+  std::vector<TenElemT> t_mat;
+  gten_samples_.GramMatrix(world_, t_mat);
+  for (size_t i = 0; i < total_num; i++) {
+    for (size_t j = 0; j < total_num; j++) {
+      t_mat[i * total_num + j] = (t_mat[i * total_num + j] - u[i] - ConjugateElem(u[j]) + ave_norm_sqr)
+          / double(total_num);
+    }
+  }
+  std::vector<TenElemT> e(total_num);
+  for (size_t i = 0; i < total_num; i++) {
+    e[i] = (energies[i] - energy) / std::sqrt(double(total_num));
+  }
+
+  auto is_finite = [](const TenElemT &elem) { return std::isfinite(std::abs(elem)); };
+  int solved = std::all_of(t_mat.cbegin(), t_mat.cend(), is_finite) && std::all_of(e.cbegin(), e.cend(), is_finite);
+  if (!solved && world_.rank() == kMasterProc) {
+    std::cout << "warning: the T matrix or the energy vector of the sample space SR is not finite." << std::endl;
+  }
+  // T is singular because sum_i a_i = 0, so the shift is necessary.
+  double shift = cg_params.diag_shift;
+  std::vector<TenElemT> y;
+  for (size_t retry = 0; solved && retry <= optimize_para.max_shift_retry; retry++) {
+    if (retry > 0) {
+      double new_shift = (shift > 0.0) ? 10 * shift : 1e-8;
+      if (world_.rank() == kMasterProc) {
+        std::cout << "warning: the T matrix of the sample space SR is not positive definite with shift "
+                  << std::scientific << shift << ", retry with shift " << new_shift << std::endl;
+      }
+      shift = new_shift;
+    }
+    std::vector<TenElemT> a = t_mat;
+    for (size_t i = 0; i < total_num; i++) {
+      a[i * total_num + i] += shift;
+    }
+    y = e;
+    if (CholeskySolve(a, y, total_num) && std::all_of(y.cbegin(), y.cend(), is_finite)) {
+      break;
+    }
+    if (retry == optimize_para.max_shift_retry) {
+      solved = false;
+    }
+  }
+  // every processor solves the same equation, the agreement is made sure against the round-off.
+  ::MPI_Allreduce(MPI_IN_PLACE, &solved, 1, MPI_INT, MPI_LAND, MPI_Comm(world_));
+  if (!solved) {
+    if (world_.rank() == kMasterProc) {
+      std::cout << "warning: the sample space SR fails, use the gradient instead of the natural gradient."
+                << std::endl;
+    }
+    natural_grad_ = grad;
+    return 0;
+  }
+
+  // natural gradient = A y = (sum_i y_i O^*(S_i) - (sum_i y_i) <O^*>) / sqrt(N)
+  std::vector<TenElemT> y_local(y.begin() + world_.rank() * local_num, y.begin() + (world_.rank() + 1) * local_num);
+  std::vector<TenElemT> res_flat;
+  gten_samples_.TransMultiply(y_local, res_flat);
+  natural_grad_ = gten_samples_.Unflatten(res_flat);
+  MPIMeanSplitIndexTPS<TenElemT, QNT>({&natural_grad_}, world_, optimize_para.replicated_update);
+  if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+    const TenElemT y_sum = std::accumulate(y.begin(), y.end(), TenElemT(0));
+    natural_grad_ = natural_grad_ * TenElemT(double(world_size)) + (-y_sum) * gten_ave_;
+    natural_grad_ *= TenElemT(1.0 / std::sqrt(double(total_num)));
+  }
+  return 1;
+}
+
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
 void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::GradientRandElementSign_() {
-  if (world_.rank() == kMasterProc)
+  if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+    // the tensor library takes std engines, which are seeded from the stream of the processor
+    std::default_random_engine sign_engine(rand_stream_());
+    std::uniform_real_distribution<double> u_double(0, 1);
     for (size_t row = 0; row < ly_; row++) {
       for (size_t col = 0; col < lx_; col++) {
         size_t dim = split_index_tps_({row, col}).size();
         for (size_t i = 0; i < dim; i++)
-          grad_({row, col})[i].ElementWiseRandSign(unit_even_distribution, random_engine);
+          grad_({row, col})[i].ElementWiseRandSign(u_double, sign_engine);
       }
     }
+  }
 }
 
 template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
-std::vector<double> VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::MCSweep_(void) {
+std::vector<double> VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::MCSweep_(
+    MarkovChain &chain) {
   std::vector<double> accept_rates;
   for (size_t i = 0; i < optimize_para.mc_sweeps_between_sample; i++) {
-    tps_sample_.MonteCarloSweepUpdate(split_index_tps_, unit_even_distribution, accept_rates);
+    chain.tps_sample.MonteCarloSweepUpdate(split_index_tps_, chain.rand_stream, accept_rates);
   }
   return accept_rates;
 }
@@ -719,13 +1726,31 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Lo
   }
   Configuration config(ly_, lx_);
   bool load_config = config.Load(tps_path, world_.rank());
-  if (load_config) {
-    tps_sample_ = WaveFunctionComponentType(split_index_tps_, config);
-  } else {
+  if (!load_config) {
     std::cout << "Loading configuration in rank " << world_.rank()
               << " fails. Use preset configuration and random warm up."
               << std::endl;
-    tps_sample_ = WaveFunctionComponentType(split_index_tps_, optimize_para.init_config);
+    config = optimize_para.init_config;
+  }
+  InitChains_(config);
+  // continue the streams of the last run if they are dumped, otherwise the fresh streams are used
+  rand_stream_.Load(ProcessorStreamPath(tps_path), world_.rank());
+  chains_[0].rand_stream.Load(tps_path, world_.rank());
+  for (size_t c = 1; c < chains_.size(); c++) {
+    chains_[c].rand_stream.Load(ChainConfigurationPath(tps_path, c), world_.rank());
+    Configuration chain_config(ly_, lx_);
+    if (chain_config.Load(ChainConfigurationPath(tps_path, c), world_.rank())) {
+      chains_[c].tps_sample = WaveFunctionComponentType(split_index_tps_, chain_config);
+    } else {
+      if (load_config) {
+        std::cout << "Loading configuration of chain " << c << " in rank " << world_.rank()
+                  << " fails. Warm up from the configuration of chain 0."
+                  << std::endl;
+      }
+      load_config = false;
+    }
+  }
+  if (!load_config) {
     WarmUp_();
   }
   warm_up_ = true;
@@ -745,9 +1770,17 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Du
     if (!gqmps2::IsPathExist(energy_data_path)) {
       gqmps2::CreatPath(energy_data_path);
     }
+    for (size_t c = 1; c < chains_.size(); c++) {
+      if (!gqmps2::IsPathExist(ChainConfigurationPath(tps_path, c))) {
+        gqmps2::CreatPath(ChainConfigurationPath(tps_path, c));
+      }
+    }
+    if (!gqmps2::IsPathExist(ProcessorStreamPath(tps_path))) {
+      gqmps2::CreatPath(ProcessorStreamPath(tps_path));
+    }
   }
   world_.barrier(); // configurations dump will collapse when creating path if there is no barrier.
-  tps_sample_.config.Dump(tps_path, world_.rank());
+  DumpChainStates_(tps_path);
   DumpVecData(energy_data_path + "/energy_sample" + std::to_string(world_.rank()), energy_samples_);
   if (world_.rank() == kMasterProc) {
     DumpVecData(energy_data_path + "/energy_trajectory", energy_trajectory_);
@@ -756,6 +1789,180 @@ void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Du
 //  DumpVecData(tps_path + "/sum_configs" + std::to_string(world_.rank()), sum_configs_);
 }
 
+///< the configurations and random streams of the chains and the processor. The paths should be created in advance.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::DumpChainStates_(
+    const std::string &tps_path) {
+  chains_[0].tps_sample.config.Dump(tps_path, world_.rank());
+  chains_[0].rand_stream.Dump(tps_path, world_.rank());
+  for (size_t c = 1; c < chains_.size(); c++) {
+    chains_[c].tps_sample.config.Dump(ChainConfigurationPath(tps_path, c), world_.rank());
+    chains_[c].rand_stream.Dump(ChainConfigurationPath(tps_path, c), world_.rank());
+  }
+  rand_stream_.Dump(ProcessorStreamPath(tps_path), world_.rank());
+}
+
+///< collective, master decides by the iteration and the time so that all the processors agree.
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::CheckpointDue_(const size_t iter) {
+  bool due = false;
+  if (world_.rank() == kMasterProc) {
+    const size_t interval = optimize_para.checkpoint_interval;
+    const double time_interval = optimize_para.checkpoint_time_interval;
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                             - last_checkpoint_time_).count();
+    due = (interval > 0 && (iter + 1) % interval == 0) || (time_interval > 0.0 && elapsed >= time_interval);
+  }
+  boost::mpi::broadcast(world_, due, kMasterProc);
+  return due;
+}
+
+/**
+ * Dump the state after the iteration iter: the TPS, the configurations and random streams of all the chains,
+ * the last natural gradient (the initial guess of the CG solver), the optimizer states, the TPS and the optimizer
+ * states before the last update (for its rejection by the step length controller), the reference of the
+ * step length controller, the current step lengths and the trajectories.
+ *
+ * The checkpoint is written to checkpoint_path + ".tmp" and then renamed to checkpoint_path by master.
+ * The iteration file is written at last, so a checkpoint without it is incomplete.
+ *
+ * The small files of the chains are written directly. The TPS and the other data of master are copied,
+ * and the copies are written by the background thread while the next iterations go on.
+ * The previous checkpoint is flushed before the temporary path is reused.
+ */
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::DumpCheckpoint_(const size_t iter) {
+  const std::string path = optimize_para.checkpoint_path;
+  const std::string tmp_path = path + ".tmp";
+  if (world_.rank() == kMasterProc) {
+    checkpoint_writer_.Flush();
+    std::filesystem::remove_all(tmp_path);
+    gqmps2::CreatPath(tmp_path);
+    for (size_t c = 1; c < chains_.size(); c++) {
+      gqmps2::CreatPath(ChainConfigurationPath(tmp_path, c));
+    }
+    gqmps2::CreatPath(ProcessorStreamPath(tmp_path));
+  }
+  world_.barrier();
+  DumpChainStates_(tmp_path);
+  world_.barrier();
+  if (world_.rank() == kMasterProc) {
+    const bool dump_natural_grad = stochastic_reconfiguration_update_class_ && !natural_grad_({0, 0}).empty();
+    const bool dump_optimizer = !momentum_optimizer_.Empty();
+    const bool dump_step_controller = optimize_para.adaptive_step_len;
+    checkpoint_writer_.Submit([tps = split_index_tps_,
+                                  natural_grad = dump_natural_grad ? natural_grad_ : SITPST(),
+                                  optimizer = dump_optimizer ? momentum_optimizer_ : MomentumOptimizer<TenElemT, QNT>(),
+                                  tps_before_update = tps_before_update_,   // empty without the adaptive step
+                                  optimizer_before_update = optimizer_before_update_,
+                                  step_controller = step_len_controller_,
+                                  energy_traj = energy_trajectory_,
+                                  energy_err_traj = energy_error_traj_,
+                                  grad_norm = grad_norm_,
+                                  step_lens = optimize_para.step_lens,
+                                  dump_natural_grad, dump_optimizer, dump_step_controller,
+                                  iter, path, tmp_path]() mutable {
+      Timer checkpoint_timer("checkpoint");
+      tps.Dump(tmp_path);
+      if (dump_natural_grad) {
+        natural_grad.Dump(tmp_path + "/natural_grad");
+      }
+      if (dump_optimizer) {
+        optimizer.Dump(tmp_path + "/optimizer");
+      }
+      if (tps_before_update.rows() > 0) {
+        tps_before_update.Dump(tmp_path + "/tps_before_update");
+        if (!optimizer_before_update.Empty()) {
+          optimizer_before_update.Dump(tmp_path + "/optimizer_before_update");
+        }
+      }
+      if (dump_step_controller) {
+        step_controller.Dump(tmp_path + "/step_length_controller");
+      }
+      DumpVecData(tmp_path + "/energy_trajectory", energy_traj);
+      DumpVecData(tmp_path + "/energy_err_trajectory", energy_err_traj);
+      DumpVecData(tmp_path + "/grad_norm", grad_norm);
+      DumpVecData(tmp_path + "/step_lens", step_lens);
+      DumpVecData(tmp_path + "/iteration", std::vector<size_t>{iter});
+      std::filesystem::remove_all(path);
+      std::filesystem::rename(tmp_path, path);
+      std::cout << "Checkpoint of iteration " << iter << " is dumped in " << path
+                << ", T = " << std::fixed << std::setprecision(2) << checkpoint_timer.Elapsed() << "s." << std::endl;
+    });
+  }
+  last_checkpoint_time_ = std::chrono::steady_clock::now();
+}
+
+///< collective, return false if there is no complete checkpoint
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+bool VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::LoadCheckpoint_(void) {
+  std::string path = optimize_para.checkpoint_path;
+  // the checkpoint may be left in the temporary path if the job is killed during the renaming
+  int found = 0; // 0: none, 1: path, 2: the temporary path
+  std::vector<size_t> iteration;
+  if (world_.rank() == kMasterProc) {
+    if (LoadVecData(path + "/iteration", iteration) && iteration.size() == 1) {
+      found = 1;
+    } else if (LoadVecData(path + ".tmp/iteration", iteration) && iteration.size() == 1) {
+      found = 2;
+    }
+  }
+  boost::mpi::broadcast(world_, found, kMasterProc);
+  if (found == 0) {
+    return false;
+  }
+  if (found == 2) {
+    path += ".tmp";
+  }
+  size_t last_iter = (world_.rank() == kMasterProc) ? iteration[0] : 0;
+  boost::mpi::broadcast(world_, last_iter, kMasterProc);
+  start_iter_ = last_iter + 1;
+
+  LoadTenData(path);
+  if (!stochastic_reconfiguration_update_class_ || !natural_grad_.Load(path + "/natural_grad")) {
+    natural_grad_ = SITPST(ly_, lx_);
+  }
+  if (world_.rank() == kMasterProc || optimize_para.replicated_update) {
+    momentum_optimizer_.Load(path + "/optimizer", ly_, lx_);
+    // the checkpoints without them cannot reject the last update
+    tps_before_update_ = SITPST(ly_, lx_);
+    if (!gqmps2::IsPathExist(path + "/tps_before_update") || !tps_before_update_.Load(path + "/tps_before_update")) {
+      tps_before_update_ = SITPST();
+    }
+    optimizer_before_update_.Load(path + "/optimizer_before_update", ly_, lx_);
+  }
+  // continue with the step lengths of the checkpoint, which may be adapted (adaptive_step_len) or
+  // shortened (fit_schedule_to_walltime) by the interrupted run.
+  std::vector<double> step_lens;
+  if (world_.rank() == kMasterProc) {
+    LoadVecData(path + "/step_lens", step_lens);
+  }
+  boost::mpi::broadcast(world_, step_lens, kMasterProc);
+  if (!step_lens.empty()) {
+    optimize_para.step_lens = step_lens;
+  }
+  // the checkpoints without the controller start with a fresh reference
+  if (optimize_para.adaptive_step_len && world_.rank() == kMasterProc) {
+    step_len_controller_.Load(path + "/step_length_controller");
+  }
+  if (world_.rank() == kMasterProc) {
+    LoadVecData(path + "/energy_trajectory", energy_trajectory_);
+    LoadVecData(path + "/energy_err_trajectory", energy_error_traj_);
+    LoadVecData(path + "/grad_norm", grad_norm_);
+    std::cout << "Resume from the checkpoint of iteration " << last_iter << " in " << path << std::endl;
+  }
+  return true;
+}
+
+template<typename TenElemT, typename QNT, typename EnergySolver, typename WaveFunctionComponentType>
+void VMCPEPSExecutor<TenElemT, QNT, EnergySolver, WaveFunctionComponentType>::Resume(void) {
+  if (!LoadCheckpoint_() && world_.rank() == kMasterProc) {
+    std::cout << "No checkpoint is found in " << optimize_para.checkpoint_path
+              << ", execute from the beginning." << std::endl;
+  }
+  Execute();
+}
+
 }//gqpeps
 
 #endif //GQPEPS_ALGORITHM_VMC_UPDATE_VMC_PEPS_IMPL_H
@@ -9,6 +9,7 @@
 #define GRACEQ_VMC_PEPS_ALGORITHM_VMC_UPDATE_WAVE_FUNCTION_COMPONENT_H
 
 #include "gqpeps/two_dim_tn/tps/configuration.h"    //Configuration
+#include "gqpeps/monte_carlo_tools/random_stream.h" //RandomStream
 #include "gqpeps/ond_dim_tn/boundary_mps/bmps.h"    //BMPSTruncatePara
 #include "gqpeps/two_dim_tn/tps/split_index_tps.h"  //SplitIndexTPS
 
@@ -27,8 +28,12 @@ class WaveFunctionComponent {
       config(rows, cols), amplitude(0) {}
   WaveFunctionComponent(const Configuration &config) : config(config), amplitude(0) {}
 
+  /**
+   * @param rand_stream   the random number stream of the Markov chain. Different chains, which may run
+   *                      in different threads, should use different streams.
+   */
   virtual void MonteCarloSweepUpdate(const SplitIndexTPS<TenElemT, QNT> &sitps,
-                                     std::uniform_real_distribution<double> &u_double,
+                                     RandomStream &rand_stream,
                                      std::vector<double> &accept_rates) = 0;
 };
 
@@ -32,10 +32,12 @@ class SquareTPSSampleNNFlip : public WaveFunctionComponent<TenElemT, QNT> {
   /**
    * @param sitps
    * @param occupancy_num
+   * @param rand_stream
    */
   void RandomInit(const SplitIndexTPS<TenElemT, QNT> &sitps,
-                  const std::vector<size_t> &occupancy_num) {
-    this->config.Random(occupancy_num);
+                  const std::vector<size_t> &occupancy_num,
+                  RandomStream &rand_stream) {
+    this->config.Random(occupancy_num, rand_stream);
     tn = TensorNetwork2D<TenElemT, QNT>(sitps, this->config);
     tn.GrowBMPSForRow(0, this->trun_para);
     tn.GrowFullBTen(RIGHT, 0, 2, true);
@@ -53,22 +55,28 @@ class SquareTPSSampleNNFlip : public WaveFunctionComponent<TenElemT, QNT> {
 //
 //  }
 
+  /**
+   * The horizontal bonds are updated from the bottom row to the top row, and then the vertical bonds from the left
+   * column to the right column. The horizontal pass reuses the up boundary MPS left by the energy solvers,
+   * and the complete left boundary MPS of the final configuration are left for the vertical pass of the solvers.
+   * The boundary MPS which are invalidated by the updates are deleted.
+   */
   void MonteCarloSweepUpdate(const SplitIndexTPS<TenElemT, QNT> &sitps,
-                             std::uniform_real_distribution<double> &u_double,
-                             std::vector<double> &accept_rates) {
+                             RandomStream &rand_stream,
+                             std::vector<double> &accept_rates) override {
     size_t flip_accept_num = 0;
-    tn.GenerateBMPSApproach(UP, this->trun_para);
-    for (size_t row = 0; row < tn.rows(); row++) {
+    tn.GenerateBMPSApproach(DOWN, this->trun_para);
+    for (size_t row = tn.rows(); row-- > 0;) {
       tn.InitBTen(LEFT, row);
       tn.GrowFullBTen(RIGHT, row, 2, true);
       for (size_t col = 0; col < tn.cols() - 1; col++) {
-        flip_accept_num += ExchangeUpdate_({row, col}, {row, col + 1}, HORIZONTAL, sitps, u_double);
+        flip_accept_num += ExchangeUpdate_({row, col}, {row, col + 1}, HORIZONTAL, sitps, rand_stream);
         if (col < tn.cols() - 2) {
           tn.BTenMoveStep(RIGHT);
         }
       }
-      if (row < tn.rows() - 1) {
-        tn.BMPSMoveStep(DOWN, this->trun_para);
+      if (row > 0) {
+        tn.BMPSMoveStep(UP, this->trun_para);
       }
     }
 
@@ -80,7 +88,7 @@ class SquareTPSSampleNNFlip : public WaveFunctionComponent<TenElemT, QNT> {
       tn.InitBTen(UP, col);
       tn.GrowFullBTen(DOWN, col, 2, true);
       for (size_t row = 0; row < tn.rows() - 1; row++) {
-        flip_accept_num += ExchangeUpdate_({row, col}, {row + 1, col}, VERTICAL, sitps, u_double);
+        flip_accept_num += ExchangeUpdate_({row, col}, {row + 1, col}, VERTICAL, sitps, rand_stream);
         if (row < tn.rows() - 2) {
           tn.BTenMoveStep(DOWN);
         }
@@ -90,21 +98,28 @@ class SquareTPSSampleNNFlip : public WaveFunctionComponent<TenElemT, QNT> {
       }
     }
 
-    tn.DeleteInnerBMPS(UP);
+    tn.DeleteInnerBMPS(DOWN);
     double bond_num = tn.cols() * (tn.rows() - 1) + tn.rows() * (tn.cols() - 1);
     accept_rates = {double(flip_accept_num) / bond_num};
   }
 
- private:
+ protected:
   bool ExchangeUpdate_(const SiteIdx &site1, const SiteIdx &site2, BondOrientation bond_dir,
                        const SplitIndexTPS<TenElemT, QNT> &sitps,
-                       std::uniform_real_distribution<double> &u_double) {
+                       RandomStream &rand_stream) {
     if (this->config(site1) == this->config(site2)) {
       return true;
     }
     assert(sitps(site1)[this->config(site1)].GetIndexes() == sitps(site1)[this->config(site2)].GetIndexes());
     TenElemT psi_b = tn.ReplaceNNSiteTrace(site1, site2, bond_dir, sitps(site1)[this->config(site2)],
                                            sitps(site2)[this->config(site1)]);
+    return AcceptExchange_(site1, site2, psi_b, sitps, rand_stream);
+  }
+
+  ///< Metropolis acceptance of the exchange with the amplitude psi_b, the configuration is updated if accepted.
+  bool AcceptExchange_(const SiteIdx &site1, const SiteIdx &site2, const TenElemT psi_b,
+                       const SplitIndexTPS<TenElemT, QNT> &sitps,
+                       RandomStream &rand_stream) {
     bool exchange;
     TenElemT &psi_a = this->amplitude;
     if (std::fabs(psi_b) >= std::fabs(psi_a)) {
@@ -112,7 +127,7 @@ class SquareTPSSampleNNFlip : public WaveFunctionComponent<TenElemT, QNT> {
     } else {
       double div = std::fabs(psi_b) / std::fabs(psi_a);
       double P = div * div;
-      if (u_double(random_engine) < P) {
+      if (rand_stream.Uniform() < P) {
         exchange = true;
       } else {
         exchange = false;
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Explicit class of wave function component in square lattice.
+*              Monte Carlo sweep realized by NN bond flip in a single pass of the horizontal boundary MPS.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_SQUARE_TPS_SAMPLE_NN_FLIP_SINGLE_PASS_H
+#define GRACEQ_VMC_PEPS_SQUARE_TPS_SAMPLE_NN_FLIP_SINGLE_PASS_H
+
+#include "gqpeps/algorithm/vmc_update/wave_function_component_classes/square_tps_sample_nn_flip.h"
+
+namespace gqpeps {
+
+/**
+ * The sweep goes row by row from the bottom to the top. In each row the horizontal bonds are updated by the
+ * one-row environments, and then the vertical bonds between the row and the row above by the two-row environments,
+ * so that only the down boundary MPS are generated in a sweep, instead of both the horizontal and the vertical
+ * boundary MPS of SquareTPSSampleNNFlip.
+ *
+ * The sweep reuses the up boundary MPS left by the horizontal pass of the energy solvers, and leaves the complete
+ * down boundary MPS for them.
+ * The acceptance rates of the horizontal and the vertical bonds are reported separately.
+ */
+template<typename TenElemT, typename QNT>
+class SquareTPSSampleNNFlipSinglePass : public SquareTPSSampleNNFlip<TenElemT, QNT> {
+ public:
+  using SquareTPSSampleNNFlip<TenElemT, QNT>::SquareTPSSampleNNFlip;
+
+  void MonteCarloSweepUpdate(const SplitIndexTPS<TenElemT, QNT> &sitps,
+                             RandomStream &rand_stream,
+                             std::vector<double> &accept_rates) override {
+    TensorNetwork2D<TenElemT, QNT> &tn = this->tn;
+    size_t horizontal_accept_num = 0, vertical_accept_num = 0;
+    tn.GenerateBMPSApproach(DOWN, this->trun_para);
+    for (size_t row = tn.rows(); row-- > 0;) {
+      tn.InitBTen(LEFT, row);
+      tn.GrowFullBTen(RIGHT, row, 2, true);
+      this->amplitude = tn.Trace({row, 0}, HORIZONTAL);
+      for (size_t col = 0; col < tn.cols() - 1; col++) {
+        horizontal_accept_num += this->ExchangeUpdate_({row, col}, {row, col + 1}, HORIZONTAL, sitps, rand_stream);
+        if (col < tn.cols() - 2) {
+          tn.BTenMoveStep(RIGHT);
+        }
+      }
+      if (row > 0) {
+        // the vertical bonds between row - 1 and row, the rows below row are not changed any more.
+        const size_t row1 = row - 1;
+        tn.InitBTen2(LEFT, row1);
+        tn.GrowFullBTen2(RIGHT, row1, 1, true);
+        // the amplitude in the two-row environments, so that the errors of the ratios cancel
+        this->amplitude = tn.ReplaceNNSiteTraceByBTen2({row1, 0}, {row, 0}, tn({row1, 0}), tn({row, 0}));
+        for (size_t col = 0; col < tn.cols(); col++) {
+          vertical_accept_num += VerticalExchangeUpdate_({row1, col}, {row, col}, sitps, rand_stream);
+          if (col < tn.cols() - 1) {
+            tn.BTen2MoveStep(RIGHT, row1);
+          }
+        }
+        tn.BMPSMoveStep(UP, this->trun_para);
+      }
+    }
+    // the vertical boundary MPS left by the energy solvers are invalid now
+    tn.DeleteInnerBMPS(LEFT);
+    tn.DeleteInnerBMPS(RIGHT);
+
+    const double horizontal_bond_num = tn.rows() * (tn.cols() - 1);
+    const double vertical_bond_num = tn.cols() * (tn.rows() - 1);
+    accept_rates = {double(horizontal_accept_num) / horizontal_bond_num,
+                    double(vertical_accept_num) / vertical_bond_num};
+  }
+
+ private:
+  bool VerticalExchangeUpdate_(const SiteIdx &site1, const SiteIdx &site2,
+                               const SplitIndexTPS<TenElemT, QNT> &sitps,
+                               RandomStream &rand_stream) {
+    if (this->config(site1) == this->config(site2)) {
+      return true;
+    }
+    TenElemT psi_b = this->tn.ReplaceNNSiteTraceByBTen2(site1, site2, sitps(site1)[this->config(site2)],
+                                                        sitps(site2)[this->config(site1)]);
+    return this->AcceptExchange_(site1, site2, psi_b, sitps, rand_stream);
+  }
+}; //SquareTPSSampleNNFlipSinglePass
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_SQUARE_TPS_SAMPLE_NN_FLIP_SINGLE_PASS_H
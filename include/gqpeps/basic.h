@@ -12,12 +12,9 @@
 
 #include <string>     // string
 #include <vector>     // vector
-#include <random>     // default_random_engine
 
 namespace gqpeps {
 
-std::default_random_engine random_engine;
-
 enum BondOrientation {
   HORIZONTAL = 0,
   VERTICAL
@@ -19,12 +19,12 @@
 
 #include <string>     // string
 #include <vector>     // vector
-#include <random>     // uniform distribution
 namespace gqpeps {
 
 const std::string kTpsPath = "tps";
 const std::string kPepsPath = "peps";
 const std::string kRuntimeTempPath = ".temp";
+const std::string kCheckpointPath = "checkpoint";
 const std::string kEnvFileBaseName = "env";
 const std::string kTpsTenBaseName = "tps_ten";
 const std::string kBoundaryMpsTenBaseName = "bmps_ten";
@@ -34,8 +34,6 @@ const size_t kMaxTaylorExpansionOrder = 1000;
 const int kEnergyOutputPrecision = 8;
 
 const size_t kMasterProc = 0;
-
-std::uniform_real_distribution<double> unit_even_distribution(0, 1);
 } /* gqpeps */
 
 
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Counter-based random number streams for the Markov chains.
+*/
+
+#ifndef GQPEPS_MONTE_CARLO_TOOLS_RANDOM_STREAM_H
+#define GQPEPS_MONTE_CARLO_TOOLS_RANDOM_STREAM_H
+
+#include <cstdint>    //uint32_t, uint64_t
+#include <array>
+#include <string>
+#include <fstream>
+#include <random>     //random_device
+#include "gqmps2/utilities.h"   //IsPathExist, CreatPath
+
+namespace gqpeps {
+
+/**
+ * Random number stream based on the counter-based generator Philox4x32-10
+ * (J. K. Salmon et al., Parallel random numbers: as easy as 1, 2, 3, SC'11).
+ *
+ * The n-th output block is a bijection of the 128-bit counter (n, stream_id) under the 64-bit key (the seed),
+ * so the streams labeled by (seed, rank, chain) are statistically independent without any communication,
+ * and the full state is a few integers which can be dumped for the restart.
+ *
+ * It satisfies the UniformRandomBitGenerator requirement and can also be used with the std distributions.
+ * But for reproducible results across the standard libraries, use Uniform() instead of std distributions.
+ */
+class RandomStream {
+ public:
+  using result_type = uint32_t;
+
+  RandomStream(void) : RandomStream(0, 0, 0) {}
+
+  RandomStream(const uint64_t seed, const uint32_t rank, const uint32_t chain) {
+    Seed(seed, rank, chain);
+  }
+
+  void Seed(const uint64_t seed, const uint32_t rank, const uint32_t chain) {
+    key_ = {uint32_t(seed), uint32_t(seed >> 32)};
+    counter_ = {0, 0, chain, rank};
+    output_idx_ = 4;
+  }
+
+  static constexpr result_type min() { return 0; }
+
+  static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+  result_type operator()() {
+    if (output_idx_ == 4) {
+      output_ = Philox4x32_10(counter_, key_);
+      IncreaseCounter_();
+      output_idx_ = 0;
+    }
+    return output_[output_idx_++];
+  }
+
+  ///< uniform double in [0, 1) with 53 random bits
+  double Uniform() {
+    const uint64_t a = (*this)() >> 5;  // 27 bits
+    const uint64_t b = (*this)() >> 6;  // 26 bits
+    return double((a << 26) | b) * (1.0 / 9007199254740992.0);
+  }
+
+  ///< uniform integer in [0, n), n > 0
+  uint64_t UniformInt(const uint64_t n) {
+    return uint64_t(Uniform() * double(n)) % n;
+  }
+
+  bool operator==(const RandomStream &rhs) const {
+    return key_ == rhs.key_ && counter_ == rhs.counter_ && output_idx_ == rhs.output_idx_;
+  }
+
+  bool operator!=(const RandomStream &rhs) const {
+    return !(*this == rhs);
+  }
+
+  /**
+   * The state is written as text, so it is portable.
+   *
+   * @param path
+   * @param label e.g. the MPI rank
+   */
+  void Dump(const std::string &path, const size_t label) const {
+    if (!gqmps2::IsPathExist(path)) { gqmps2::CreatPath(path); }
+    std::string file = path + "/random_stream" + std::to_string(label);
+    std::ofstream ofs(file, std::ofstream::binary);
+    for (auto k : key_) {
+      ofs << k << std::endl;
+    }
+    for (auto c : counter_) {
+      ofs << c << std::endl;
+    }
+    ofs << output_idx_ << std::endl;
+    ofs.close();
+  }
+
+  ///< return false if the file does not exist, in which case the stream is unchanged.
+  bool Load(const std::string &path, const size_t label) {
+    std::string file = path + "/random_stream" + std::to_string(label);
+    std::ifstream ifs(file, std::ifstream::binary);
+    if (!ifs) {
+      return false;
+    }
+    std::array<uint32_t, 2> key;
+    std::array<uint32_t, 4> counter;
+    size_t output_idx;
+    for (auto &k : key) {
+      ifs >> k;
+    }
+    for (auto &c : counter) {
+      ifs >> c;
+    }
+    ifs >> output_idx;
+    ifs.close();
+    if (ifs.fail() || output_idx > 4) {
+      return false;
+    }
+    key_ = key;
+    counter_ = counter;
+    output_idx_ = output_idx;
+    if (output_idx_ < 4) {  // recover the current output block, generated by the previous counter
+      std::array<uint32_t, 4> prev_counter = counter_;
+      if (prev_counter[0]-- == 0) {
+        prev_counter[1]--;
+      }
+      output_ = Philox4x32_10(prev_counter, key_);
+    }
+    return true;
+  }
+
+  static std::array<uint32_t, 4> Philox4x32_10(std::array<uint32_t, 4> ctr, std::array<uint32_t, 2> key) {
+    for (size_t round = 0; round < 10; round++) {
+      if (round > 0) {
+        key[0] += kPhiloxW0;
+        key[1] += kPhiloxW1;
+      }
+      const uint64_t prod0 = uint64_t(kPhiloxM0) * ctr[0];
+      const uint64_t prod1 = uint64_t(kPhiloxM1) * ctr[2];
+      ctr = {uint32_t(prod1 >> 32) ^ ctr[1] ^ key[0], uint32_t(prod1),
+             uint32_t(prod0 >> 32) ^ ctr[3] ^ key[1], uint32_t(prod0)};
+    }
+    return ctr;
+  }
+
+ private:
+  ///< the low 64 bits of the counter count the blocks, the high 64 bits label the stream
+  void IncreaseCounter_() {
+    if (++counter_[0] == 0) {
+      ++counter_[1];
+    }
+  }
+
+  static constexpr uint32_t kPhiloxM0 = 0xD2511F53u;
+  static constexpr uint32_t kPhiloxM1 = 0xCD9E8D57u;
+  static constexpr uint32_t kPhiloxW0 = 0x9E3779B9u;
+  static constexpr uint32_t kPhiloxW1 = 0xBB67AE85u;
+
+  std::array<uint32_t, 2> key_;
+  std::array<uint32_t, 4> counter_;   // counter of the next output block
+  std::array<uint32_t, 4> output_;
+  size_t output_idx_;                 // 4 means the output block is used up
+};
+
+///< the stream id of the processor-level (not chain) random numbers, e.g. the random step length
+const uint32_t kProcessorStreamId = 0xFFFFFFFFu;
+
+///< a seed from std::random_device, used when the users do not give a seed
+inline uint64_t RandomDeviceSeed(void) {
+  std::random_device rd;
+  return (uint64_t(rd()) << 32) | uint64_t(rd());
+}
+
+}//gqpeps
+
+#endif //GQPEPS_MONTE_CARLO_TOOLS_RANDOM_STREAM_H
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Correlated sampling (reweighting) estimate of the energy.
+*/
+
+#ifndef GQPEPS_MONTE_CARLO_TOOLS_REWEIGHTING_H
+#define GQPEPS_MONTE_CARLO_TOOLS_REWEIGHTING_H
+
+#include <array>
+#include <tuple>
+#include <cmath>
+#include <limits>
+#include <complex>
+#include <algorithm>
+#include "boost/mpi.hpp"
+#include "gqpeps/utility/mpi_type.h"     //MPIDataType
+
+namespace gqpeps {
+
+/**
+ * Sums over the samples S_i of the weights w_i and the local energies E_i for the reweighted energy
+ *      E = sum_i w_i E_i / sum_i w_i.
+ */
+template<typename ElemT>
+struct ReweightingSums {
+  std::array<double, 3> real_sums{};  // sum w, sum w^2, sum w^2 |E|^2
+  std::array<ElemT, 2> elem_sums{};   // sum w E, sum w^2 E
+  size_t sample_num = 0;
+
+  void Add(const double w, const ElemT energy) {
+    real_sums[0] += w;
+    real_sums[1] += w * w;
+    real_sums[2] += w * w * std::norm(energy);
+    elem_sums[0] += w * energy;
+    elem_sums[1] += (w * w) * energy;
+    sample_num++;
+  }
+
+  ReweightingSums &operator+=(const ReweightingSums &rhs) {
+    for (size_t k = 0; k < real_sums.size(); k++) {
+      real_sums[k] += rhs.real_sums[k];
+    }
+    for (size_t k = 0; k < elem_sums.size(); k++) {
+      elem_sums[k] += rhs.elem_sums[k];
+    }
+    sample_num += rhs.sample_num;
+    return *this;
+  }
+
+  ///< sum over the processors of comm, the results are available in all of them
+  void AllReduce(const boost::mpi::communicator &comm) {
+    MPI_Datatype data_type = MPIDataType<ElemT>();
+    ::MPI_Allreduce(MPI_IN_PLACE, real_sums.data(), real_sums.size(), MPI_DOUBLE, MPI_SUM, MPI_Comm(comm));
+    ::MPI_Allreduce(MPI_IN_PLACE, elem_sums.data(), elem_sums.size(), data_type, MPI_SUM, MPI_Comm(comm));
+    sample_num = boost::mpi::all_reduce(comm, sample_num, std::plus<size_t>());
+  }
+
+  /**
+   * @return the energy, its standard error, and the effective sample size ratio (sum_i w_i)^2 / (N sum_i w_i^2).
+   *         If all the weights vanish, (0, infinity, 0) so that the estimate is rejected by any ESS threshold.
+   */
+  std::tuple<ElemT, double, double> Estimate(void) const {
+    const double w_sum = real_sums[0], w2_sum = real_sums[1];
+    if (w_sum <= 0.0 || w2_sum <= 0.0 || sample_num == 0) {
+      return std::make_tuple(ElemT(0), std::numeric_limits<double>::infinity(), 0.0);
+    }
+    const ElemT energy = elem_sums[0] * (1.0 / w_sum);
+    const double err_sqr = (real_sums[2] - 2.0 * std::real(std::conj(energy) * elem_sums[1])
+        + std::norm(energy) * w2_sum) / (w_sum * w_sum);
+    const double ess_ratio = w_sum * w_sum / (w2_sum * double(sample_num));
+    return std::make_tuple(energy, std::sqrt(std::max(err_sqr, 0.0)), ess_ratio);
+  }
+};
+
+}//gqpeps
+
+#endif //GQPEPS_MONTE_CARLO_TOOLS_REWEIGHTING_H
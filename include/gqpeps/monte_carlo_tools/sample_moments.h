@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Scalar sums of the samples for the error estimates of the adaptive sampling.
+*/
+
+#ifndef GQPEPS_MONTE_CARLO_TOOLS_SAMPLE_MOMENTS_H
+#define GQPEPS_MONTE_CARLO_TOOLS_SAMPLE_MOMENTS_H
+
+#include <array>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include "boost/mpi.hpp"
+#include "gqpeps/consts.h"      //kMasterProc
+
+namespace gqpeps {
+
+///< sums over the samples of the local energy E and the norm of O^*, see SamplingConverged
+struct SampleMoments {
+  // N, Re(E), Im(E), |E|^2, |O|^2, Re(E)|O|^2, Im(E)|O|^2, |E|^2|O|^2
+  std::array<double, 8> sums{};
+
+  template<typename ElemT>
+  void Add(const ElemT energy, const double o_norm_sqr) {
+    const double e_norm_sqr = std::norm(energy);
+    sums[0] += 1.0;
+    sums[1] += std::real(energy);
+    sums[2] += std::imag(energy);
+    sums[3] += e_norm_sqr;
+    sums[4] += o_norm_sqr;
+    sums[5] += std::real(energy) * o_norm_sqr;
+    sums[6] += std::imag(energy) * o_norm_sqr;
+    sums[7] += e_norm_sqr * o_norm_sqr;
+  }
+
+  SampleMoments &operator+=(const SampleMoments &rhs) {
+    for (size_t i = 0; i < sums.size(); i++) {
+      sums[i] += rhs.sums[i];
+    }
+    return *this;
+  }
+
+  std::complex<double> EnergyMean(void) const {
+    return std::complex<double>(sums[1] / sums[0], sums[2] / sums[0]);
+  }
+
+  ///< standard error of the energy mean by the sample variance
+  double EnergyError(void) const {
+    const double n = sums[0];
+    return std::sqrt(std::max(sums[3] / n - std::norm(EnergyMean()), 0.0) / n);
+  }
+
+  /**
+   * Standard error of the gradient g = <(E - <E>) O^*> by the trace of its covariance,
+   *      <|E - <E>|^2 |O|^2> - |g|^2,
+   * divided by the sample number, where |g|^2 is given by grad_norm_sqr.
+   */
+  double GradientError(const double grad_norm_sqr) const {
+    const double n = sums[0];
+    const std::complex<double> e_ave = EnergyMean();
+    const double x_norm_sqr = (sums[7] - 2.0 * (e_ave.real() * sums[5] + e_ave.imag() * sums[6])
+        + std::norm(e_ave) * sums[4]) / n;
+    return std::sqrt(std::max(x_norm_sqr - grad_norm_sqr, 0.0) / n);
+  }
+};
+
+/**
+ * Whether the samples of moments reach the relative error targets. The non-positive targets do not apply, and the
+ * gradient target applies only if check_grad. The gradient norm square of the last iteration, grad_norm_sqr, is used
+ * as the scale of the gradient error, so the gradient target is never reached if it is 0 (the first iteration).
+ * The sampling is not regarded converged if no target applies.
+ */
+inline bool SamplingConverged(const SampleMoments &moments,
+                              const double energy_target, const double grad_target,
+                              const double grad_norm_sqr, const bool check_grad) {
+  bool applicable = false;
+  bool converged = true;
+  if (energy_target > 0.0) {
+    applicable = true;
+    converged = converged && moments.EnergyError() < energy_target * std::abs(moments.EnergyMean());
+  }
+  if (grad_target > 0.0 && check_grad) {
+    applicable = true;
+    converged = converged && grad_norm_sqr > 0.0
+        && moments.GradientError(grad_norm_sqr) < grad_target * std::sqrt(grad_norm_sqr);
+  }
+  return converged && applicable;
+}
+
+/**
+ * Collective version, the moments of all the processors in comm are summed in master, which decides
+ * and broadcasts the decision, so all the processors stop at the same block.
+ * grad_norm_sqr is only used in master.
+ */
+inline bool SamplingConverged(const SampleMoments &local_moments,
+                              const double energy_target, const double grad_target,
+                              const double grad_norm_sqr, const bool check_grad,
+                              const boost::mpi::communicator &comm) {
+  SampleMoments moments = local_moments;
+  std::array<double, 8> &sums = moments.sums;
+  if (comm.rank() == kMasterProc) {
+    ::MPI_Reduce(MPI_IN_PLACE, sums.data(), sums.size(), MPI_DOUBLE, MPI_SUM, kMasterProc, MPI_Comm(comm));
+  } else {
+    ::MPI_Reduce(sums.data(), nullptr, sums.size(), MPI_DOUBLE, MPI_SUM, kMasterProc, MPI_Comm(comm));
+  }
+  bool converged = false;
+  if (comm.rank() == kMasterProc) {
+    converged = SamplingConverged(moments, energy_target, grad_target, grad_norm_sqr, check_grad);
+  }
+  boost::mpi::broadcast(comm, converged, kMasterProc);
+  return converged;
+}
+
+}//gqpeps
+
+#endif //GQPEPS_MONTE_CARLO_TOOLS_SAMPLE_MOMENTS_H
@@ -10,21 +10,25 @@
 
 #include <vector>
 #include <fstream>
+#include <iomanip>      //setprecision
 #include <algorithm>
 
 #include "boost/mpi.hpp"
 
 #include "gqpeps/consts.h"      //kMasterProc
+#include "gqpeps/utility/mpi_type.h"     //MPIDataType
 
 namespace gqpeps {
 using namespace boost::mpi;
 
+///< the floating point numbers are written with 17 significant digits, so that LoadVecData reads them back exactly.
 template<typename DataType>
 void DumpVecData(
     const std::string &filename,
     const std::vector<DataType> &data
 ) {
   std::ofstream ofs(filename, std::ofstream::binary);
+  ofs << std::setprecision(17);
   for (auto datum : data) {
     ofs << datum << '\n';
   }
@@ -32,6 +36,25 @@ void DumpVecData(
   ofs.close();
 }
 
+///< read the data written by DumpVecData, return false if the file does not exist
+template<typename DataType>
+bool LoadVecData(
+    const std::string &filename,
+    std::vector<DataType> &data
+) {
+  std::ifstream ifs(filename, std::ifstream::binary);
+  if (!ifs) {
+    return false;
+  }
+  data.clear();
+  DataType datum;
+  while (ifs >> datum) {
+    data.push_back(datum);
+  }
+  ifs.close();
+  return true;
+}
+
 template<typename T>
 T Mean(const std::vector<T> data) {
   if (data.empty()) {
@@ -119,18 +142,8 @@ std::pair<ElemT, double> GatherStatisticSingleData(
   if (comm_rank == kMasterProc) {
     gather_data = new ElemT[comm_size];
   }
-  if (sizeof(ElemT) == sizeof(double)) {
-    int err_msg = ::MPI_Gather((void *) &data, 1, MPI_DOUBLE, (void *) gather_data, 1, MPI_DOUBLE, kMasterProc, comm);
-  } else if (sizeof(ElemT) == sizeof(std::complex<double>)) {
-    int err_msg = ::MPI_Gather((void *) &data,
-                               1,
-                               MPI_DOUBLE_COMPLEX,
-                               (void *) gather_data,
-                               1,
-                               MPI_DOUBLE_COMPLEX,
-                               kMasterProc,
-                               comm);
-  }
+  ::MPI_Gather((void *) &data, 1, MPIDataType<ElemT>(), (void *) gather_data, 1, MPIDataType<ElemT>(),
+               kMasterProc, comm);
 
   if (comm_rank == kMasterProc) {
     ElemT sum = 0.0;
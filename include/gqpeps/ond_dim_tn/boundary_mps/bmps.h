@@ -13,6 +13,7 @@
 #include "gqmps2/one_dim_tn/mps/finite_mps/finite_mps.h"
 #include "gqmps2/one_dim_tn/mpo/mpo.h"
 #include "gqpeps/basic.h"                       //BMPSPOSITION
+#include "gqpeps/ond_dim_tn/boundary_mps/truncated_svd.h"
 //if above include doesn't work, include mps_all.h
 
 namespace gqpeps {
@@ -30,12 +31,35 @@ struct BMPSTruncatePara {
   size_t D_max;
   double trunc_err;
   CompressMPSScheme compress_scheme;
+  ///< variational methods only. The sweeps stop if the norm of the result grows by less than ConvergenceTol()
+  ///< (relatively) in a sweep, or after iter_max sweeps.
+  size_t iter_max = 5;
+  ///< negative for the default, see ConvergenceTol()
+  double convergence_tol = -1.0;
+  ///< variational methods only. Start the compressions from the boundary MPS of the last sweep kept in
+  ///< TensorNetwork2D, instead of the SVD compressed initial guess, so that most of the compressions converge
+  ///< in one sweep. See TensorNetwork2D::GetBMPSCompressStatistics.
+  ///< The kept boundary MPS double the memory of the boundary MPS of each TensorNetwork2D, i.e. each Markov chain.
+  bool warm_start = false;
+  ///< the SVD backend of the 2-site variational compressions and of RightCanonicalizeTruncate
+  TruncatedSVDPara svd_para;
 
   BMPSTruncatePara(void) = default;
 
   BMPSTruncatePara(size_t d_min, size_t d_max, double trunc_error,
                    CompressMPSScheme compress_scheme = VARIATION2Site)
       : D_min(d_min), D_max(d_max), trunc_err(trunc_error), compress_scheme(compress_scheme) {}
+
+  /**
+   * convergence_tol if it is set, otherwise 1e-15, which keeps the sweeps of the cold starts as before,
+   * or 1e-10 with the warm start, so that a converged initial guess stops after one sweep.
+   */
+  double ConvergenceTol(void) const {
+    if (convergence_tol >= 0.0) {
+      return convergence_tol;
+    }
+    return warm_start ? 1e-10 : 1e-15;
+  }
 };
 
 
@@ -104,7 +128,8 @@ class BMPS : public TenVec<GQTensor<TenElemT, QNT>> {
 
   GQTensor<GQTEN_Double, QNT> RightCanonicalizeTen(const size_t);
 
-  double RightCanonicalizeTruncate(const size_t, const size_t, const size_t, const double);
+  double RightCanonicalizeTruncate(const size_t, const size_t, const size_t, const double,
+                                   const TruncatedSVDPara &svd_para = TruncatedSVDPara());
 
   int GetCenter(void) const { return center_; }
 
@@ -135,6 +160,21 @@ class BMPS : public TenVec<GQTensor<TenElemT, QNT>> {
                    const size_t max_iter = 5, //only valid for variational methods
                    const CompressMPSScheme &scheme = VARIATION2Site) const;
 
+  /**
+   * Multiplication with all the parameters given by trunc_para.
+   * The variational multiplication starts from init_guess, e.g. the result of the last multiplication by a similar
+   * mpo. init_guess should be right canonical, and pass IsCompatibleInitGuess.
+   * If init_guess == nullptr, the initial guess is given by InitGuessForVariationalMPOMultiplication_.
+   *
+   * @param sweep_num  output the number of the sweeps if not nullptr
+   */
+  BMPS MultipleMPO(TransferMPO &, const BMPSTruncatePara &trunc_para,
+                   const BMPS *init_guess = nullptr,
+                   size_t *sweep_num = nullptr) const;
+
+  ///< whether guess has the same sites, physical indices and quantum number divergence as the product with mpo
+  bool IsCompatibleInitGuess(const TransferMPO &, const BMPS &guess) const;
+
   BMPS MultipleMPOWithPhyIdx(TransferMPO &, const size_t, const size_t, const double,
                              const size_t max_iter = 5, //only valid for variational methods
                              const CompressMPSScheme &scheme = VARIATION2Site) const;
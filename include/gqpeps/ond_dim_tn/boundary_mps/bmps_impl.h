@@ -133,17 +133,19 @@ GQTensor<GQTEN_Double, QNT> BMPS<TenElemT, QNT>::RightCanonicalizeTen(const size
 template<typename TenElemT, typename QNT>
 double
 BMPS<TenElemT, QNT>::RightCanonicalizeTruncate(const size_t site, const size_t Dmin,
-                                               const size_t Dmax, const double trunc_err) {
+                                               const size_t Dmax, const double trunc_err,
+                                               const TruncatedSVDPara &svd_para) {
 
   GQTensor<GQTEN_Double, QNT> s;
   auto pvt = new Tensor;
   Tensor u;
   double actual_trunc_err;
   size_t D;
-  SVD(
+  TruncatedSVD(
       (*this)(site),
       1, qn0_, trunc_err, Dmin, Dmax,
-      &u, &s, pvt, &actual_trunc_err, &D
+      &u, &s, pvt, &actual_trunc_err, &D,
+      svd_para
   );
 //  std::cout << "Truncate MPS bond " << std::setw(4) << site
 //            << " TruncErr = " << std::setprecision(2) << std::scientific << actual_trunc_err << std::fixed
@@ -286,14 +288,54 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
                                  const size_t Dmin, const size_t Dmax,
                                  const double trunc_err, const size_t iter_max,
                                  const CompressMPSScheme &scheme) const {
+  BMPSTruncatePara trunc_para(Dmin, Dmax, trunc_err, scheme);
+  trunc_para.iter_max = iter_max;
+  trunc_para.convergence_tol = 1e-15;
+  return MultipleMPO(mpo, trunc_para);
+}
+
+template<typename TenElemT, typename QNT>
+bool BMPS<TenElemT, QNT>::IsCompatibleInitGuess(const BMPS::TransferMPO &mpo, const BMPS &guess) const {
+  const size_t N = this->size();
+  if (guess.size() != N || mpo.size() != N) {
+    return false;
+  }
+  const size_t mpo_remain_idx = static_cast<size_t>(Opposite(position_));
+  for (size_t i = 0; i < N; i++) {
+    const size_t mpo_idx = (MPOIndex(position_) < 2) ? i : N - 1 - i;
+    if (!(guess[i].GetIndex(1) == mpo[mpo_idx]->GetIndex(mpo_remain_idx))) {
+      return false;
+    }
+  }
+  QNT qn_mpo = mpo[0]->Div(), qn_mps = (*this)[0].Div(), qn_guess = guess[0].Div();
+  for (size_t i = 1; i < N; i++) {
+    qn_mpo += mpo[i]->Div();
+    qn_mps += (*this)[i].Div();
+    qn_guess += guess[i].Div();
+  }
+  return qn_mpo + qn_mps == qn_guess;
+}
+
+template<typename TenElemT, typename QNT>
+BMPS<TenElemT, QNT>
+BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
+                                 const BMPSTruncatePara &trunc_para,
+                                 const BMPS *init_guess,
+                                 size_t *sweep_num) const {
+  const size_t Dmin = trunc_para.D_min, Dmax = trunc_para.D_max, iter_max = trunc_para.iter_max;
+  const double trunc_err = trunc_para.trunc_err, converge_tol = trunc_para.ConvergenceTol();
+  const CompressMPSScheme &scheme = trunc_para.compress_scheme;
   const size_t N = this->size();
   assert(mpo.size() == N);
   size_t pre_post = (MPOIndex(position_) + 3) % 4; //equivalent to -1, but work for 0
   size_t next_post = ((size_t) (position_) + 1) % 4;
-  const double converge_tol = 1e-15;  // for variational methods
+  if (sweep_num != nullptr) {
+    *sweep_num = 0;
+  }
   if (N == 2 && scheme != SVD_COMPRESS) {
-    return MultipleMPO(mpo, Dmin, Dmax,
-                       trunc_err, iter_max, SVD_COMPRESS);
+    BMPSTruncatePara svd_trunc_para(trunc_para);
+    svd_trunc_para.compress_scheme = SVD_COMPRESS;
+    return MultipleMPO(mpo, svd_trunc_para);
   }
 #ifndef NDEBUG
   auto mpo_original = mpo;
@@ -335,7 +377,7 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
         }
       }
       for (size_t i = N - 1; i > 0; --i) {
-        res.RightCanonicalizeTruncate(i, Dmin, Dmax, trunc_err);
+        res.RightCanonicalizeTruncate(i, Dmin, Dmax, trunc_err, trunc_para.svd_para);
       }
 #ifndef NDEBUG
       MultipleMPOResCheck_(mpo_original, *this, res, position_);
@@ -343,7 +385,11 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
       return res;
     }
     case VARIATION2Site: {
-      BMPS<TenElemT, QNT> res_init = InitGuessForVariationalMPOMultiplication_(mpo, Dmin, Dmax, trunc_err);
+      assert(init_guess == nullptr || IsCompatibleInitGuess(mpo, *init_guess));
+      BMPS<TenElemT, QNT> res_init = (init_guess != nullptr) ? *init_guess
+                                                             : InitGuessForVariationalMPOMultiplication_(mpo, Dmin,
+                                                                                                         Dmax,
+                                                                                                         trunc_err);
       if (position_ == RIGHT || position_ == UP) {
         std::reverse(mpo.begin(), mpo.end());
       }
@@ -377,7 +423,7 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
         renvs.emplace_back(renv_next);
       }
 
-      Tensor s12bond_last;
+      double sweep_start_norm = 0.0;
       for (size_t iter = 0; iter < iter_max; iter++) {
         //left move
         GQTensor<GQTEN_Double, QNT> s;
@@ -394,10 +440,14 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
           s = GQTensor<GQTEN_Double, QNT>();
           double actual_trunc_err;
           size_t D;
-          SVD(tmp + 4,
-              2, res_dag[i].Div(), trunc_err, Dmin, Dmax,
-              pu, &s, pvt, &actual_trunc_err, &D
+          TruncatedSVD(tmp + 4,
+                       2, res_dag[i].Div(), trunc_err, Dmin, Dmax,
+                       pu, &s, pvt, &actual_trunc_err, &D,
+                       trunc_para.svd_para
           );
+          if (i == 0) {
+            sweep_start_norm = s.Get2Norm();
+          }
 
           delete res_dag(i);
           res_dag(i) = pu;
@@ -423,9 +473,10 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
           s = GQTensor<GQTEN_Double, QNT>();
           double actual_trunc_err;
           size_t D;
-          SVD(tmp + 4,
-              2, res_dag[i].Div(), trunc_err, Dmin, Dmax,
-              pu, &s, pvt, &actual_trunc_err, &D
+          TruncatedSVD(tmp + 4,
+                       2, res_dag[i].Div(), trunc_err, Dmin, Dmax,
+                       pu, &s, pvt, &actual_trunc_err, &D,
+                       trunc_para.svd_para
           );
 
           delete res_dag(i + 1);
@@ -436,20 +487,14 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
           lenvs.pop_back();
           delete pu;
         }
-        if (iter == 0 || s.GetActualDataSize() != s12bond_last.GetActualDataSize()) {
-          s12bond_last = s;
-          continue;
-        }
-        double diff = 0.0;
-        const double *s_data = s.GetRawDataPtr();
-        const double *s_last_data = s12bond_last.GetRawDataPtr();
-        for (size_t k = 0; k < s.GetActualDataSize(); k++) {
-          diff += std::fabs(*(s_data + k) - *(s_last_data + k));
+        if (sweep_num != nullptr) {
+          *sweep_num = iter + 1;
         }
-        if (diff < converge_tol) {
+        // the norm of the result grows in a sweep until it converges, which may happen in the first sweep
+        // if the initial guess is good.
+        const double sweep_end_norm = s.Get2Norm();
+        if (sweep_end_norm - sweep_start_norm <= converge_tol * sweep_end_norm) {
           break;
-        } else {
-          s12bond_last = s;
         }
       }
       Tensor tmp[6];
@@ -464,9 +509,10 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
       GQTensor<GQTEN_Double, QNT> s;
       double actual_trunc_err;
       size_t D;
-      SVD(tmp + 4,
-          2, res_dag[0].Div(), trunc_err, Dmin, Dmax,
-          &u, &s, pvt, &actual_trunc_err, &D
+      TruncatedSVD(tmp + 4,
+                   2, res_dag[0].Div(), trunc_err, Dmin, Dmax,
+                   &u, &s, pvt, &actual_trunc_err, &D,
+                   trunc_para.svd_para
       );
 
       delete res_dag(0);
@@ -489,7 +535,10 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
     }
     case VARIATION1Site: {
       // Copy the code from VARIATIONAL2Site
-      BMPS<TenElemT, QNT> res_init = InitGuessForVariationalMPOMultiplication_(mpo, Dmax, Dmax, 0.0);
+      assert(init_guess == nullptr || IsCompatibleInitGuess(mpo, *init_guess));
+      BMPS<TenElemT, QNT> res_init = (init_guess != nullptr) ? *init_guess
+                                                             : InitGuessForVariationalMPOMultiplication_(mpo, Dmax,
+                                                                                                         Dmax, 0.0);
       if (position_ == RIGHT || position_ == UP) {
         std::reverse(mpo.begin(), mpo.end());
       }
@@ -653,7 +702,7 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
         for (size_t i = N - 1; i > 0; i--) {
           Tensor tmp[4];
           Contract<TenElemT, QNT, true, true>((*this)[i], renvs.back(), 2, 0, 1, tmp[0]);
-          Contract<TenElemT, QNT, false, false>(tmp[2], *mpo[i], 1, position_, 2, tmp[1]);
+          Contract<TenElemT, QNT, false, false>(tmp[0], *mpo[i], 1, position_, 2, tmp[1]);
           Contract(tmp + 1, {3, 1}, &lenvs.back(), {1, 2}, tmp + 2);
           tmp[2].Dag();
           Tensor *pq = new Tensor(), r;
@@ -664,12 +713,15 @@ BMPS<TenElemT, QNT>::MultipleMPO(BMPS::TransferMPO &mpo,
           res_dag(i) = pq;
           //grow renvs
           Contract(&tmp[1], {2, 0}, res_dag(i), {1, 2}, &tmp[3]);
-          renvs.emplace_back(tmp[5]);
+          renvs.emplace_back(tmp[3]);
           lenvs.pop_back();
 
           r_norm = r.Get2Norm();
         }
-        if (iter == 0 || std::abs(r_norm - last_r_norm) > converge_tol) {
+        if (sweep_num != nullptr) {
+          *sweep_num = iter + 1;
+        }
+        if (iter == 0 || std::abs(r_norm - last_r_norm) > converge_tol * r_norm) {
           last_r_norm = r_norm;
           continue;
         } else {
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Truncated SVD of the symmetry-blocked tensors for compressing boundary MPS.
+*/
+
+#ifndef GQPEPS_OND_DIM_TN_BOUNDARY_MPS_TRUNCATED_SVD_H
+#define GQPEPS_OND_DIM_TN_BOUNDARY_MPS_TRUNCATED_SVD_H
+
+#include <numeric>                              //iota
+#include <algorithm>                            //min, max
+#include <complex>
+#include <random>                               //default_random_engine, normal_distribution
+#include "gqten/gqten.h"
+
+namespace gqpeps {
+using namespace gqten;
+
+enum TruncatedSVDScheme {
+  FULL_SVD,
+  RANDOMIZED_SVD
+};
+
+struct TruncatedSVDPara {
+  TruncatedSVDScheme scheme = FULL_SVD;
+  ///< RANDOMIZED_SVD: D_max + oversampling random vectors in each symmetry block (at most the size of the block),
+  ///< refined by power_iter power iterations.
+  size_t oversampling = 10;
+  size_t power_iter = 2;
+  ///< RANDOMIZED_SVD: fall back to the full SVD if the weight missed by the sketch exceeds guard_ratio times
+  ///< the truncated weight (or trunc_err if larger).
+  double guard_ratio = 0.1;
+  ///< RANDOMIZED_SVD: the random vectors are drawn by a local engine of this seed in each call, so that the results
+  ///< are reproducible and independent of the threads.
+  unsigned seed = 0;
+};
+
+inline void NormalRandomElem(std::default_random_engine &engine, std::normal_distribution<double> &normal,
+                             double &elem) {
+  elem = normal(engine);
+}
+
+inline void NormalRandomElem(std::default_random_engine &engine, std::normal_distribution<double> &normal,
+                             std::complex<double> &elem) {
+  const double real = normal(engine);
+  elem = std::complex<double>(real, normal(engine));
+}
+
+/**
+ * Zero divergence tensor with the indices of t and the normal random elements drawn by engine,
+ * instead of the global rand() of GQTensor::Random which is neither reproducible nor thread safe.
+ */
+template<typename TenElemT, typename QNT>
+void FillNormalRandom(GQTensor<TenElemT, QNT> &t, std::default_random_engine &engine) {
+  t.Fill(QNT::Zero(), TenElemT(1));
+  const auto &blk_spar_data_ten = t.GetBlkSparDataTen();
+  // only the values of the blocks allocated by Fill are overwritten
+  TenElemT *data = const_cast<TenElemT *>(blk_spar_data_ten.GetActualRawDataPtr());
+  std::normal_distribution<double> normal(0.0, 1.0);
+  for (size_t i = 0; i < blk_spar_data_ten.GetActualRawDataSize(); i++) {
+    NormalRandomElem(engine, normal, data[i]);
+  }
+}
+
+/**
+ * The index whose sectors are the fused sectors of the inverse of idxs, so that the zero divergence tensors
+ * with the indices (InverseIndex(idxs[0]), ..., fused index) are nonzero in all the symmetry blocks.
+ * Only 1 or 2 indices are supported.
+ */
+template<typename TenElemT, typename QNT>
+Index<QNT> FusedIndex(const std::vector<Index<QNT>> &idxs) {
+  if (idxs.size() == 1) {
+    return idxs[0];
+  }
+  return IndexCombine<TenElemT, QNT>(InverseIndex(idxs[0]), InverseIndex(idxs[1]), OUT).GetIndex(2);
+}
+
+/**
+ * Randomized range finding per symmetry block: A ~ Q Q^dag A with Q spanned by A Omega, followed by the full SVD
+ * of the small Q^dag A. Omega has min(Dmax + oversampling, block dimension) random vectors in each symmetry block
+ * of the right indices of A, since any single block may hold all the Dmax kept singular values.
+ * The flops scale with Dmax instead of the sizes of the blocks.
+ *
+ * The arguments are the same as the ones of gqten::SVD, *pt is not changed.
+ * The randomized result is checked by the norm missed by the sketch, and replaced by the full SVD if it is
+ * not accurate enough, or if the sketch is not smaller than the tensor.
+ *
+ * @return true if the randomized result is kept, false if the full SVD is used.
+ */
+template<typename TenElemT, typename QNT>
+bool TruncatedSVD(GQTensor<TenElemT, QNT> *pt, const size_t ldims, const QNT &lqndiv,
+                  const double trunc_err, const size_t Dmin, const size_t Dmax,
+                  GQTensor<TenElemT, QNT> *pu, GQTensor<GQTEN_Double, QNT> *ps, GQTensor<TenElemT, QNT> *pvt,
+                  double *pactual_trunc_err, size_t *pD,
+                  const TruncatedSVDPara &para) {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  using IndexT = Index<QNT>;
+  const size_t rank = pt->Rank();
+  const size_t rdims = rank - ldims;
+  if (para.scheme == FULL_SVD || ldims == 0 || rdims == 0 || rdims > 2) {
+    SVD(pt, ldims, lqndiv, trunc_err, Dmin, Dmax, pu, ps, pvt, pactual_trunc_err, pD);
+    return false;
+  }
+
+  std::vector<IndexT> right_idxs;
+  for (size_t i = ldims; i < rank; i++) {
+    right_idxs.push_back(pt->GetIndex(i));
+  }
+  const IndexT fused_idx = FusedIndex<TenElemT, QNT>(right_idxs);
+  const size_t fused_dim = fused_idx.dim();
+  std::vector<QNSector<QNT>> sketch_scts;
+  size_t sketch_dim = 0;
+  for (size_t i = 0; i < fused_idx.GetQNSctNum(); i++) {
+    const QNSector<QNT> sct = fused_idx.GetQNSct(i);
+    const size_t degeneracy = std::min(sct.GetDegeneracy(), Dmax + para.oversampling);
+    sketch_scts.push_back(QNSector<QNT>(sct.GetQn(), degeneracy));
+    sketch_dim += degeneracy;
+  }
+  if (sketch_dim >= fused_dim) {
+    SVD(pt, ldims, lqndiv, trunc_err, Dmin, Dmax, pu, ps, pvt, pactual_trunc_err, pD);
+    return false;
+  }
+
+  std::vector<size_t> left_axes(ldims), right_axes(rdims), omega_axes(rdims), sketch_axes(rdims);
+  std::iota(left_axes.begin(), left_axes.end(), 0);
+  std::iota(right_axes.begin(), right_axes.end(), ldims);
+  std::iota(omega_axes.begin(), omega_axes.end(), 0);
+  std::iota(sketch_axes.begin(), sketch_axes.end(), 1);
+
+  std::vector<IndexT> omega_idxs;
+  for (const IndexT &idx : right_idxs) {
+    omega_idxs.push_back(InverseIndex(idx));
+  }
+  omega_idxs.push_back(IndexT(sketch_scts, fused_idx.GetDir()));
+  Tensor omega(omega_idxs);
+  std::default_random_engine engine(para.seed);
+  FillNormalRandom(omega, engine);
+
+  Tensor y, q, r, q_dag, b;
+  Contract(pt, right_axes, &omega, omega_axes, &y);
+  for (size_t iter = 0; iter <= para.power_iter; iter++) {
+    if (iter > 0) {
+      Tensor b_dag(b);
+      b_dag.Dag();
+      y = Tensor();
+      Contract(pt, right_axes, &b_dag, sketch_axes, &y);
+    }
+    q = Tensor();
+    r = Tensor();
+    QR(&y, ldims, lqndiv, &q, &r);
+    q_dag = q;
+    q_dag.Dag();
+    b = Tensor();
+    Contract(&q_dag, left_axes, pt, left_axes, &b); // b = Q^dag A
+  }
+
+  Tensor ub;
+  double b_trunc_err;
+  SVD(&b, 1, QNT::Zero(), trunc_err, Dmin, Dmax, &ub, ps, pvt, &b_trunc_err, pD);
+
+  const double a_norm = pt->Get2Norm(), b_norm = b.Get2Norm(), s_norm = ps->Get2Norm();
+  const double a_weight = a_norm * a_norm;
+  const double missed_weight = (a_weight > 0.0) ? std::max(0.0, 1.0 - b_norm * b_norm / a_weight) : 0.0;
+  const double actual_trunc_err = (a_weight > 0.0) ? std::max(0.0, 1.0 - s_norm * s_norm / a_weight) : 0.0;
+  if (a_weight == 0.0 || missed_weight > para.guard_ratio * std::max(actual_trunc_err, trunc_err)) {
+    *ps = GQTensor<GQTEN_Double, QNT>();
+    *pvt = Tensor();
+    SVD(pt, ldims, lqndiv, trunc_err, Dmin, Dmax, pu, ps, pvt, pactual_trunc_err, pD);
+    return false;
+  }
+  *pu = Tensor();
+  Contract(&q, {ldims}, &ub, {0}, pu);
+  *pactual_trunc_err = actual_trunc_err;
+  return true;
+}
+
+}//gqpeps
+
+#endif //GQPEPS_OND_DIM_TN_BOUNDARY_MPS_TRUNCATED_SVD_H
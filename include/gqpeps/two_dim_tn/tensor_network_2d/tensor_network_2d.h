@@ -25,6 +25,22 @@ class SplitIndexTPS;
 
 using BTenPOSITION = BMPSPOSITION;
 
+///< statistics of the variational compressions of the boundary MPS, to monitor the warm start
+struct BMPSCompressStatistics {
+  size_t compress_num = 0;    ///< number of the variational compressions
+  size_t warm_start_num = 0;  ///< number of the compressions started from the boundary MPS of the last sweep
+  size_t sweep_num = 0;       ///< total number of the sweeps
+  size_t one_sweep_num = 0;   ///< number of the compressions converged in one sweep
+
+  BMPSCompressStatistics &operator+=(const BMPSCompressStatistics &rhs) {
+    compress_num += rhs.compress_num;
+    warm_start_num += rhs.warm_start_num;
+    sweep_num += rhs.sweep_num;
+    one_sweep_num += rhs.one_sweep_num;
+    return *this;
+  }
+};
+
 /**  2-dimensional finite-size tensor network and its environments (boundary MPS and so on)
  *         3
  *         |
@@ -55,6 +71,11 @@ class TensorNetwork2D : public TenMatrix<GQTensor<TenElemT, QNT>> {
     return bmps_set_[position];
   }
 
+  /**
+   * Keep only the boundary bmps at post, and grow the full boundary MPS set of the opposite position.
+   * The existing boundary MPS of the opposite position are reused, so the boundary MPS which are invalidated
+   * by UpdateSiteConfig should be deleted by the caller (see DeleteInnerBMPS).
+   */
   const std::map<BMPSPOSITION, std::vector<BMPS<TenElemT, QNT>>> &
   GenerateBMPSApproach(BMPSPOSITION post, const BMPSTruncatePara &trunc_para);
 
@@ -134,6 +155,15 @@ class TensorNetwork2D : public TenMatrix<GQTensor<TenElemT, QNT>> {
                               const BondOrientation bond_dir,
                               const Tensor &ten_a, const Tensor &ten_b) const;
 
+  /**
+   * Replace the two sites of a vertical NN bond and trace the two rows (site_a[0], site_b[0]) between the up and
+   * down boundary MPS, by the two-layer boundary tensors bten_set2_ at the left and the right of the column.
+   * It allows the vertical bonds to be evaluated in the pass of the horizontal boundary MPS.
+   * We assume bten_set2_[LEFT] has been grown to the column and bten_set2_[RIGHT] to the next column.
+   */
+  TenElemT ReplaceNNSiteTraceByBTen2(const SiteIdx &site_a, const SiteIdx &site_b,
+                                     const Tensor &ten_a, const Tensor &ten_b) const;
+
   TenElemT ReplaceNNNSiteTrace(const SiteIdx &left_up_site,
                                const DIAGONAL_DIR nnn_dir,
                                const BondOrientation mps_orient,
@@ -146,6 +176,18 @@ class TensorNetwork2D : public TenMatrix<GQTensor<TenElemT, QNT>> {
 
   Tensor PunchHole(const SiteIdx &site, const BondOrientation mps_orient) const;
 
+  ///< the same as above, but the hole is written into hole (e.g. the tensors of the hole TensorNetwork2D reused by
+  ///< every sample) without the temporary copy, so that it can be conjugated in place.
+  void PunchHole(const SiteIdx &site, const BondOrientation mps_orient, Tensor &hole) const;
+
+  const BMPSCompressStatistics &GetBMPSCompressStatistics(void) const {
+    return bmps_compress_stat_;
+  }
+
+  void ClearBMPSCompressStatistics(void) {
+    bmps_compress_stat_ = BMPSCompressStatistics();
+  }
+
  private:
   /**
  * grow one step for the boundary MPS
@@ -182,6 +224,13 @@ class TensorNetwork2D : public TenMatrix<GQTensor<TenElemT, QNT>> {
   std::map<BMPSPOSITION, std::vector<BMPS<TenElemT, QNT>>> bmps_set_;
   std::map<BTenPOSITION, std::vector<Tensor>> bten_set_;  // for 1 layer between two bmps
   std::map<BTenPOSITION, std::vector<Tensor>> bten_set2_; // for 2 layers between two bmps
+
+  /** the last boundary MPS grown at each position of bmps_set_, which are kept when bmps_set_ is cleared
+   * and used as the initial guesses of the variational compressions if BMPSTruncatePara::warm_start.
+   * Empty BMPS for none. With the warm start they double the memory of the boundary MPS of each Markov chain.
+   */
+  std::map<BMPSPOSITION, std::vector<BMPS<TenElemT, QNT>>> bmps_guess_set_;
+  BMPSCompressStatistics bmps_compress_stat_;
 };
 
 }//gqpeps
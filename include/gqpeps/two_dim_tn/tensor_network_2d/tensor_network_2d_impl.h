@@ -22,6 +22,7 @@ TensorNetwork2D<TenElemT, QNT>::TensorNetwork2D(const size_t rows, const size_t
     bmps_set_.insert(std::make_pair(post, std::vector<BMPS<TenElemT, QNT>>()));
     const size_t mps_max_num = this->length(Orientation(post));
     bmps_set_[post].reserve(mps_max_num);
+    bmps_guess_set_.insert(std::make_pair(post, std::vector<BMPS<TenElemT, QNT>>(mps_max_num, BMPST(post, 0))));
 
     bten_set_.insert(std::make_pair(static_cast<BTenPOSITION>(post_int), std::vector<Tensor>()));
   }
@@ -57,6 +58,8 @@ TensorNetwork2D<TenElemT, QNT> &TensorNetwork2D<TenElemT, QNT>::operator=(const
   TenMatrix<Tensor>::operator=(tn);
   bmps_set_ = tn.bmps_set_;
   bten_set_ = tn.bten_set_;
+  bmps_guess_set_ = tn.bmps_guess_set_;
+  bmps_compress_stat_ = tn.bmps_compress_stat_;
   return *this;
 }
 
@@ -73,9 +76,25 @@ size_t TensorNetwork2D<TenElemT, QNT>::GrowBMPSStep_(const BMPSPOSITION position
                                                      TransferMPO mpo,
                                                      const BMPSTruncatePara &trunc_para) {
   std::vector<BMPS<TenElemT, QNT>> &bmps_set = bmps_set_[position];
-  bmps_set.push_back(
-      bmps_set.back().MultipleMPO(mpo, trunc_para.D_min, trunc_para.D_max, trunc_para.trunc_err,
-                                  trunc_para.compress_scheme));
+  if (trunc_para.compress_scheme == SVD_COMPRESS) {
+    bmps_set.push_back(bmps_set.back().MultipleMPO(mpo, trunc_para));
+    return bmps_set.size();
+  }
+  BMPST &guess = bmps_guess_set_[position][bmps_set.size()];
+  const BMPST *init_guess = nullptr;
+  if (trunc_para.warm_start && guess.size() > 0 && bmps_set.back().IsCompatibleInitGuess(mpo, guess)) {
+    // e.g. the quantum numbers of the rows may change by the Monte Carlo updates, then the guess is not compatible.
+    init_guess = &guess;
+  }
+  size_t sweep_num;
+  bmps_set.push_back(bmps_set.back().MultipleMPO(mpo, trunc_para, init_guess, &sweep_num));
+  bmps_compress_stat_.compress_num++;
+  bmps_compress_stat_.warm_start_num += (init_guess != nullptr);
+  bmps_compress_stat_.sweep_num += sweep_num;
+  bmps_compress_stat_.one_sweep_num += (sweep_num == 1);
+  if (trunc_para.warm_start) {
+    guess = bmps_set.back();
+  }
   return bmps_set.size();
 }
 
@@ -123,6 +142,7 @@ void TensorNetwork2D<TenElemT, QNT>::GrowFullBMPS(const BMPSPOSITION position, c
         const TransferMPO &mpo = this->get_col(col);
         GrowBMPSStep_(position, mpo, trunc_para);
       }
+      break;
     }
     case RIGHT: {
       for (size_t col = cols - existed_bmps_size; col > 0; col--) {
@@ -803,6 +823,46 @@ TensorNetwork2D<TenElemT, QNT>::ReplaceNNSiteTrace(const SiteIdx &site_a, const
   return tmp[6]();
 }
 
+template<typename TenElemT, typename QNT>
+TenElemT TensorNetwork2D<TenElemT, QNT>::ReplaceNNSiteTraceByBTen2(const SiteIdx &site_a, const SiteIdx &site_b,
+                                                                   const Tensor &ten_a, const Tensor &ten_b) const {
+#ifndef NDEBUG
+  assert(site_a[0] + 1 == site_b[0]);
+  assert(site_a[1] == site_b[1]);
+  assert(bten_set2_.at(LEFT).size() > site_a[1]);
+  assert(bten_set2_.at(RIGHT).size() + site_a[1] >= this->cols());
+#endif
+  /*
+   *       BTEN2-LEFT      BTEN2-RIGHT
+   * MPS UP    ++-----mps_ten1-----++
+   *           ||        |         ||
+   *           ||        |         ||
+   * TN ROW1   ||------ten_a-------||
+   *           ||        |         ||
+   *           ||        |         ||
+   * TN ROW2   ||------ten_b-------||
+   *           ||        |         ||
+   *           ||        |         ||
+   * MPS DOWN  ++-----mps_ten2-----++
+   *
+  */
+  const size_t row1 = site_a[0];
+  const size_t row2 = site_b[0];
+  const size_t col = site_a[1];
+  const Tensor &mps_ten1 = bmps_set_.at(UP)[row1][this->cols() - col - 1];
+  const Tensor &mps_ten2 = bmps_set_.at(DOWN)[this->rows() - 1 - row2][col];
+  Tensor mpo_ten1 = ten_a;
+  mpo_ten1.Transpose({3, 0, 2, 1});
+  // the left boundary tensor grows over the column in the same way as GrowBTen2Step_(LEFT)
+  Tensor tmp[5];
+  Contract<TenElemT, QNT, true, true>(mps_ten1, bten_set2_.at(LEFT)[col], 2, 0, 1, tmp[0]);
+  Contract<TenElemT, QNT, false, true>(tmp[0], mpo_ten1, 1, 0, 2, tmp[1]);
+  Contract<TenElemT, QNT, false, false>(tmp[1], ten_b, 4, 3, 2, tmp[2]);
+  Contract(&tmp[2], {0, 3}, &mps_ten2, {0, 1}, &tmp[3]);
+  Contract(&tmp[3], {0, 1, 2, 3}, &bten_set2_.at(RIGHT)[this->cols() - col - 1], {3, 2, 1, 0}, &tmp[4]);
+  return tmp[4]();
+}
+
 template<typename TenElemT, typename QNT>
 TenElemT TensorNetwork2D<TenElemT, QNT>::ReplaceNNNSiteTrace(const SiteIdx &left_up_site,
                                                              const DIAGONAL_DIR nnn_dir,
@@ -1066,6 +1126,15 @@ TenElemT TensorNetwork2D<TenElemT, QNT>::ReplaceSqrt5DistTwoSiteTrace(const Site
 template<typename TenElemT, typename QNT>
 GQTensor<TenElemT, QNT> TensorNetwork2D<TenElemT, QNT>::PunchHole(const gqpeps::SiteIdx &site,
                                                                   const gqpeps::BondOrientation mps_orient) const {
+  Tensor res_ten;
+  PunchHole(site, mps_orient, res_ten);
+  return res_ten;
+}
+
+template<typename TenElemT, typename QNT>
+void TensorNetwork2D<TenElemT, QNT>::PunchHole(const gqpeps::SiteIdx &site,
+                                               const gqpeps::BondOrientation mps_orient,
+                                               Tensor &hole) const {
   const Tensor *left_ten, *down_ten, *right_ten, *up_ten;
   const size_t row = site[0];
   const size_t col = site[1];
@@ -1080,11 +1149,11 @@ GQTensor<TenElemT, QNT> TensorNetwork2D<TenElemT, QNT>::PunchHole(const gqpeps::
     left_ten = &(bmps_set_.at(LEFT)[col][row]);
     right_ten = &(bmps_set_.at(RIGHT)[this->cols() - col - 1][this->rows() - row - 1]);
   }
-  Tensor tmp1, tmp2, res_ten;
+  Tensor tmp1, tmp2;
   Contract(left_ten, {2}, down_ten, {0}, &tmp1);
   Contract(right_ten, {2}, up_ten, {0}, &tmp2);
-  Contract(&tmp1, {0, 3}, &tmp2, {3, 0}, &res_ten);
-  return res_ten;
+  hole = Tensor(); // the contraction only writes into a default tensor
+  Contract(&tmp1, {0, 3}, &tmp2, {3, 0}, &hole);
 }
 
 template<typename TenElemT, typename QNT>
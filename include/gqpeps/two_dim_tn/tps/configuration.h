@@ -7,8 +7,8 @@
 #ifndef GQPEPS_ALGORITHM_VMC_UPDATE_CONFIGURATION_H
 #define GQPEPS_ALGORITHM_VMC_UPDATE_CONFIGURATION_H
 
-#include <random>
 #include "gqpeps/two_dim_tn/framework/duomatrix.h"
+#include "gqpeps/monte_carlo_tools/random_stream.h"   //RandomStream
 #include "mpi.h"        //MPI BroadCast
 
 namespace gqpeps {
@@ -24,9 +24,9 @@ class Configuration : public DuoMatrix<size_t> {
    *
    * @param occupancy_num  a vector with length dim, where dim is the dimension of loccal hilbert space
    *                  occupancy_num[i] indicates how many sites occupy the i-th state.
-   * @param seed seed for random number generator
+   * @param rand_stream
    */
-  void Random(const std::vector<size_t> &occupancy_num) {
+  void Random(const std::vector<size_t> &occupancy_num, RandomStream &rand_stream) {
     size_t dim = occupancy_num.size();
     size_t rows = this->rows();
     size_t cols = this->cols();
@@ -40,13 +40,10 @@ class Configuration : public DuoMatrix<size_t> {
     }
     assert(off_set == data.size());
 
-    // random_device can generate different random number during the running
-    // and do not need to feed the seed;
-    // But if the mt19937 is not feed the seed, the rand number it generate in
-    // each time is the same.
-    std::random_device rd;
-    std::mt19937 rand_num_gen(rd());
-    std::shuffle(data.begin(), data.end(), rand_num_gen);
+    // Fisher-Yates shuffle. std::shuffle is not used because its result depends on the standard library.
+    for (size_t i = data.size(); i > 1; i--) {
+      std::swap(data[i - 1], data[rand_stream.UniformInt(i)]);
+    }
 
     for (size_t row = 0; row < rows; row++) {
       for (size_t col = 0; col < cols; col++) {
@@ -55,6 +52,12 @@ class Configuration : public DuoMatrix<size_t> {
     }
   }
 
+  ///< random configuration with a seed from std::random_device, so it is not reproducible
+  void Random(const std::vector<size_t> &occupancy_num) {
+    RandomStream rand_stream(RandomDeviceSeed(), 0, 0);
+    Random(occupancy_num, rand_stream);
+  }
+
   size_t Sum(void) const {
     size_t summation = 0;
     size_t rows = this->rows();
@@ -11,6 +11,7 @@
 #include "gqten/gqten.h"
 #include "gqpeps/two_dim_tn/framework/ten_matrix.h"
 #include "gqpeps/two_dim_tn/tps/tps.h"                  // TPS
+#include "gqpeps/utility/mpi_type.h"                   //MPIDataType
 
 namespace gqpeps {
 using namespace gqten;
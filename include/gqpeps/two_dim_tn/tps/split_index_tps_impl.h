@@ -306,6 +306,248 @@ size_t CGSolverRecvVector(
   return actual_src;
 }
 
+///< Copy the raw data of all the non-default tensors into one contiguous buffer.
+template<typename TenElemT, typename QNT>
+void PackSplitIndexTPSData(
+    const std::vector<SplitIndexTPS<TenElemT, QNT> *> &sitps_list,
+    std::vector<TenElemT> &buffer
+) {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  size_t buffer_size = 0;
+  for (auto psitps : sitps_list) {
+    for (size_t row = 0; row < psitps->rows(); ++row) {
+      for (size_t col = 0; col < psitps->cols(); ++col) {
+        for (const Tensor &ten : (*psitps)({row, col})) {
+          if (!ten.IsDefault()) {
+            buffer_size += ten.GetActualDataSize();
+          }
+        }
+      }
+    }
+  }
+  buffer.resize(buffer_size);
+  size_t offset = 0;
+  for (auto psitps : sitps_list) {
+    for (size_t row = 0; row < psitps->rows(); ++row) {
+      for (size_t col = 0; col < psitps->cols(); ++col) {
+        for (const Tensor &ten : (*psitps)({row, col})) {
+          if (!ten.IsDefault()) {
+            const TenElemT *data = ten.GetRawDataPtr();
+            std::copy(data, data + ten.GetActualDataSize(), buffer.data() + offset);
+            offset += ten.GetActualDataSize();
+          }
+        }
+      }
+    }
+  }
+}
+
+///< Inverse of PackSplitIndexTPSData, the data are multiplied by scale. The tensors should keep the block structures.
+template<typename TenElemT, typename QNT>
+void UnpackSplitIndexTPSData(
+    const std::vector<SplitIndexTPS<TenElemT, QNT> *> &sitps_list,
+    const std::vector<TenElemT> &buffer,
+    const double scale = 1.0
+) {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  size_t offset = 0;
+  for (auto psitps : sitps_list) {
+    for (size_t row = 0; row < psitps->rows(); ++row) {
+      for (size_t col = 0; col < psitps->cols(); ++col) {
+        for (Tensor &ten : (*psitps)({row, col})) {
+          if (ten.IsDefault()) {
+            continue;
+          }
+          // the raw data are owned by the tensor, write the data directly.
+          TenElemT *data = const_cast<TenElemT *>(ten.GetRawDataPtr());
+          for (size_t i = 0; i < ten.GetActualDataSize(); i++) {
+            data[i] = buffer[offset + i] * scale;
+          }
+          offset += ten.GetActualDataSize();
+        }
+      }
+    }
+  }
+  assert(offset == buffer.size());
+}
+
+/**
+ * Sum a list of SplitIndexTPS over all the processors by packing all the tensor raw data into one buffer
+ * and reducing it with a single MPI_Allreduce/MPI_Reduce. The results are multiplied by scale.
+ *
+ * @param sitps_list  the data to be reduced, in place.
+ * @param world
+ * @param all_reduce  if true, the results are available in every processor, otherwise only in master.
+ * @param scale
+ *
+ * @note the block structures of the tensors are required to be the same in all the processors,
+ *       e.g. all the tensors are filled with full blocks by Fill(div, 0) before accumulation.
+ *       Default tensors are skipped and should be default in all the processors.
+ */
+template<typename TenElemT, typename QNT>
+void MPIReduceSplitIndexTPS(
+    const std::vector<SplitIndexTPS<TenElemT, QNT> *> &sitps_list,
+    const boost::mpi::communicator &world,
+    const bool all_reduce,
+    const double scale
+) {
+  if (world.size() == 1) {
+    return;
+  }
+  std::vector<TenElemT> buffer;
+  PackSplitIndexTPSData(sitps_list, buffer);
+  const size_t buffer_size = buffer.size();
+#ifndef NDEBUG
+  unsigned long long local_size = buffer_size, min_size, max_size;
+  ::MPI_Allreduce(&local_size, &min_size, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, MPI_Comm(world));
+  ::MPI_Allreduce(&local_size, &max_size, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_Comm(world));
+  assert(min_size == max_size);
+#endif
+  MPI_Datatype data_type = MPIDataType<TenElemT>();
+  if (all_reduce) {
+    ::MPI_Allreduce(MPI_IN_PLACE, buffer.data(), buffer_size, data_type, MPI_SUM, MPI_Comm(world));
+  } else if (world.rank() == kMasterProc) {
+    ::MPI_Reduce(MPI_IN_PLACE, buffer.data(), buffer_size, data_type, MPI_SUM, kMasterProc, MPI_Comm(world));
+  } else {
+    ::MPI_Reduce(buffer.data(), nullptr, buffer_size, data_type, MPI_SUM, kMasterProc, MPI_Comm(world));
+    return;
+  }
+  UnpackSplitIndexTPSData(sitps_list, buffer, scale);
+}
+
+///< Average a list of SplitIndexTPS over all the processors, see MPIReduceSplitIndexTPS
+template<typename TenElemT, typename QNT>
+void MPIMeanSplitIndexTPS(
+    const std::vector<SplitIndexTPS<TenElemT, QNT> *> &sitps_list,
+    const boost::mpi::communicator &world,
+    const bool all_reduce = false
+) {
+  MPIReduceSplitIndexTPS(sitps_list, world, all_reduce, 1.0 / double(world.size()));
+}
+
+///< Sum the vector over all the processors, results are available in every processor.
+template<typename TenElemT, typename QNT>
+void CGSolverAllReduceVector(
+    SplitIndexTPS<TenElemT, QNT> &v,
+    const boost::mpi::communicator &world
+) {
+  MPIReduceSplitIndexTPS<TenElemT, QNT>({&v}, world, true, 1.0);
+}
+
+/**
+ * The data sizes of all the tensors, and size_t(-1) for the default tensors.
+ * The addition of tensors takes the union of the blocks, so if the signature is unchanged
+ * by an update like sitps += step * grad, the block structures are unchanged.
+ */
+template<typename TenElemT, typename QNT>
+std::vector<size_t> DataSizeSignature(const SplitIndexTPS<TenElemT, QNT> &sitps) {
+  std::vector<size_t> signature;
+  for (size_t row = 0; row < sitps.rows(); ++row) {
+    for (size_t col = 0; col < sitps.cols(); ++col) {
+      for (const auto &ten : sitps({row, col})) {
+        signature.push_back(ten.IsDefault() ? size_t(-1) : ten.GetActualDataSize());
+      }
+    }
+  }
+  return signature;
+}
+
+/**
+ * 64-bit FNV-1a hash of the DataSizeSignature and the bytes of the raw data,
+ * used to check that the replicas of the TPS in different processors are bit-identical.
+ */
+template<typename TenElemT, typename QNT>
+uint64_t SplitIndexTPSChecksum(const SplitIndexTPS<TenElemT, QNT> &sitps) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto hash_bytes = [&hash](const void *data, const size_t byte_num) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < byte_num; i++) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+  const std::vector<size_t> signature = DataSizeSignature(sitps);
+  hash_bytes(signature.data(), signature.size() * sizeof(size_t));
+  for (size_t row = 0; row < sitps.rows(); ++row) {
+    for (size_t col = 0; col < sitps.cols(); ++col) {
+      for (const auto &ten : sitps({row, col})) {
+        if (!ten.IsDefault()) {
+          hash_bytes(ten.GetRawDataPtr(), ten.GetActualDataSize() * sizeof(TenElemT));
+        }
+      }
+    }
+  }
+  return hash;
+}
+
+/**
+ * Broadcast the tensor data of sitps from master without the block structures.
+ *
+ * The raw data are packed into one contiguous buffer, which is sent row by row by non-blocking MPI_Ibcast
+ * posted all at once, so that the received rows are unpacked while the following rows are in flight.
+ * Compared with BroadCast, which sends the tensors one by one with their structures,
+ * the number of messages is reduced from rows * cols * phy_dim to rows.
+ *
+ * @note the other processors should hold the SplitIndexTPS with the same block structures as master,
+ *       e.g. the replicas before an update which keeps the DataSizeSignature.
+ */
+template<typename TenElemT, typename QNT>
+void BroadCastSplitIndexTPSData(
+    SplitIndexTPS<TenElemT, QNT> &sitps,
+    const boost::mpi::communicator &world
+) {
+  using Tensor = GQTensor<TenElemT, QNT>;
+  if (world.size() == 1) {
+    return;
+  }
+  const size_t rows = sitps.rows(), cols = sitps.cols();
+  std::vector<size_t> row_offset(rows + 1, 0);
+  for (size_t row = 0; row < rows; ++row) {
+    row_offset[row + 1] = row_offset[row];
+    for (size_t col = 0; col < cols; ++col) {
+      for (const Tensor &ten : sitps({row, col})) {
+        if (!ten.IsDefault()) {
+          row_offset[row + 1] += ten.GetActualDataSize();
+        }
+      }
+    }
+  }
+#ifndef NDEBUG
+  unsigned long long local_size = row_offset[rows], min_size, max_size;
+  ::MPI_Allreduce(&local_size, &min_size, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, MPI_Comm(world));
+  ::MPI_Allreduce(&local_size, &max_size, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_Comm(world));
+  assert(min_size == max_size);
+#endif
+  std::vector<TenElemT> buffer;
+  if (world.rank() == kMasterProc) {
+    PackSplitIndexTPSData<TenElemT, QNT>({&sitps}, buffer);
+  } else {
+    buffer.resize(row_offset[rows]);
+  }
+  MPI_Datatype data_type = MPIDataType<TenElemT>();
+  std::vector<MPI_Request> requests(rows);
+  for (size_t row = 0; row < rows; ++row) {
+    ::MPI_Ibcast(buffer.data() + row_offset[row], row_offset[row + 1] - row_offset[row], data_type,
+                 kMasterProc, MPI_Comm(world), &requests[row]);
+  }
+  for (size_t row = 0; row < rows; ++row) {
+    ::MPI_Wait(&requests[row], MPI_STATUS_IGNORE);
+    if (world.rank() == kMasterProc) {
+      continue;
+    }
+    size_t offset = row_offset[row];
+    for (size_t col = 0; col < cols; ++col) {
+      for (Tensor &ten : sitps({row, col})) {
+        if (ten.IsDefault()) {
+          continue;
+        }
+        TenElemT *data = const_cast<TenElemT *>(ten.GetRawDataPtr());
+        std::copy(buffer.data() + offset, buffer.data() + offset + ten.GetActualDataSize(), data);
+        offset += ten.GetActualDataSize();
+      }
+    }
+  }
+}
+
 }//gqpeps
 
 #endif //GRACEQ_VMC_PEPS_SPLIT_INDEX_TPS_IMPL_H
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Background thread for the file output.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_BACKGROUND_WRITER_H
+#define GRACEQ_VMC_PEPS_BACKGROUND_WRITER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+namespace gqpeps {
+
+/**
+ * A single background thread which runs the submitted tasks, e.g. dumping a snapshot of the data, in order.
+ * The tasks should own the data they write, so that the computation can go on with the original data.
+ *
+ * Flush() is the fence which waits for all the submitted tasks. It is also called by the destructor.
+ */
+class BackgroundWriter {
+ public:
+  BackgroundWriter(void) : stop_(false), busy_(false), worker_(&BackgroundWriter::Run_, this) {}
+
+  BackgroundWriter(const BackgroundWriter &) = delete;
+  BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+
+  ~BackgroundWriter() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    task_cv_.notify_one();
+    worker_.join();
+  }
+
+  void Submit(std::function<void(void)> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    task_cv_.notify_one();
+  }
+
+  void Flush(void) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return tasks_.empty() && !busy_; });
+  }
+
+ private:
+  void Run_(void) {
+    while (true) {
+      std::function<void(void)> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        task_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) { // stop_, and all the tasks are done
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        busy_ = true;
+      }
+      task();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_ = false;
+      }
+      idle_cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<std::function<void(void)>> tasks_;
+  bool stop_;
+  bool busy_;
+  std::thread worker_;  // initialized at last, after the other members
+};
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_BACKGROUND_WRITER_H
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Dense Cholesky solver for small Hermitian positive definite linear equations.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_CHOLESKY_SOLVER_H
+#define GRACEQ_VMC_PEPS_CHOLESKY_SOLVER_H
+
+#include <stddef.h>   //size_t
+#include <vector>
+#include <complex>
+#include <cmath>
+#include "gqten/framework/hp_numeric/omp_set.h"  //GetTensorManipulationThreads
+#include "gqpeps/utility/conjugate_elem.h"          //ConjugateElem
+
+namespace gqpeps {
+
+/**
+ * Cholesky decomposition A = L * L^dag of a n x n Hermitian positive definite matrix A.
+ *
+ * @param a   row-major matrix A. Overwritten by L in the lower triangle.
+ * @param n
+ * @return false if A is not positive definite (numerically), in which case a is destroyed.
+ */
+template<typename ElemT>
+bool CholeskyDecompose(
+    std::vector<ElemT> &a,
+    const size_t n
+) {
+  for (size_t j = 0; j < n; j++) {
+    ElemT diag = a[j * n + j];
+    for (size_t k = 0; k < j; k++) {
+      diag -= a[j * n + k] * ConjugateElem(a[j * n + k]);
+    }
+    double pivot = std::real(diag);
+    if (!(pivot > 0.0)) {
+      return false;
+    }
+    pivot = std::sqrt(pivot);
+    a[j * n + j] = pivot;
+#pragma omp parallel for num_threads(gqten::hp_numeric::GetTensorManipulationThreads()) schedule(static)
+    for (size_t i = j + 1; i < n; i++) {
+      ElemT sum = a[i * n + j];
+      for (size_t k = 0; k < j; k++) {
+        sum -= a[i * n + k] * ConjugateElem(a[j * n + k]);
+      }
+      a[i * n + j] = sum / pivot;
+    }
+  }
+  return true;
+}
+
+/**
+ * solve L * L^dag * x = b, where L is given by CholeskyDecompose.
+ *
+ * @param l   row-major, L in the lower triangle
+ * @param b   pointer to the right hand side with n elements. Overwritten by the solution x.
+ * @param n
+ */
+template<typename ElemT>
+void CholeskySubstitute(
+    const std::vector<ElemT> &l,
+    ElemT *b,
+    const size_t n
+) {
+  // L * y = b
+  for (size_t i = 0; i < n; i++) {
+    ElemT sum = b[i];
+    for (size_t k = 0; k < i; k++) {
+      sum -= l[i * n + k] * b[k];
+    }
+    b[i] = sum / l[i * n + i];
+  }
+  // L^dag * x = y
+  for (size_t i = n; i-- > 0;) {
+    ElemT sum = b[i];
+    for (size_t k = i + 1; k < n; k++) {
+      sum -= ConjugateElem(l[k * n + i]) * b[k];
+    }
+    b[i] = sum / l[i * n + i];
+  }
+}
+
+/**
+ * solve the equation
+ *          A * x = b
+ * where A is a n x n Hermitian positive definite matrix, by the Cholesky decomposition A = L * L^dag.
+ *
+ * @param a   row-major matrix A. Overwritten by L in the lower triangle.
+ * @param b   right hand side. Overwritten by the solution x.
+ * @param n
+ * @return false if A is not positive definite (numerically), in which case a and b are destroyed.
+ */
+template<typename ElemT>
+bool CholeskySolve(
+    std::vector<ElemT> &a,
+    std::vector<ElemT> &b,
+    const size_t n
+) {
+  if (!CholeskyDecompose(a, n)) {
+    return false;
+  }
+  CholeskySubstitute(a, b.data(), n);
+  return true;
+}
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_CHOLESKY_SOLVER_H
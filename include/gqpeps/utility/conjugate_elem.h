@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Complex conjugation of the real and complex scalar elements.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_CONJUGATE_ELEM_H
+#define GRACEQ_VMC_PEPS_CONJUGATE_ELEM_H
+
+#include <complex>
+
+namespace gqpeps {
+
+inline double ConjugateElem(const double a) { return a; }
+
+inline std::complex<double> ConjugateElem(const std::complex<double> &a) { return std::conj(a); }
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_CONJUGATE_ELEM_H
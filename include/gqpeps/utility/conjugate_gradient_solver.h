@@ -11,6 +11,8 @@
 #define GRACEQ_VMC_PEPS_CONJUGATE_GRADIENT_SOLVER_H
 
 #include <stddef.h>   //size_t
+#include <vector>
+#include <type_traits>
 #include <boost/mpi.hpp>
 #include "gqpeps/consts.h"    //kMasterProc
 
@@ -29,6 +31,19 @@ using gqten::Timer;
 
 namespace gqpeps {
 
+/**
+ * Preconditioner M = 1, the default of the parallel conjugate gradient solvers.
+ *
+ * A preconditioner is a functor, operator()(r) returns M^(-1) * r, where M is a
+ * self-conjugated positive definite approximation of the matrix A.
+ */
+struct IdentityPreconditioner {
+  template<typename VectorType>
+  const VectorType &operator()(const VectorType &r) const {
+    return r;
+  }
+};
+
 /**
  * solve the equation
  *          A * x = b
@@ -105,7 +120,7 @@ void ConjugateGradientSolverSlave(
     const boost::mpi::communicator &world
 );
 
-template<typename MatrixType, typename VectorType>
+template<typename MatrixType, typename VectorType, typename PreconditionerType>
 VectorType ConjugateGradientSolverMaster(
     const MatrixType &matrix_a,
     const VectorType &b,
@@ -114,7 +129,8 @@ VectorType ConjugateGradientSolverMaster(
     double tolerance,
     int,
     size_t &iter,
-    const boost::mpi::communicator &world
+    const boost::mpi::communicator &world,
+    const PreconditionerType &precond
 );
 
 // virtual forward declaration
@@ -164,10 +180,32 @@ VectorType ConjugateGradientSolver(
     const int residue_restart_step,
     size_t &iter,    //return value
     const boost::mpi::communicator &world
+) {
+  return ConjugateGradientSolver(matrix_a, b, x0, max_iter, tolerance, residue_restart_step, iter, world,
+                                 IdentityPreconditioner());
+}
+
+/**
+ * Preconditioned parallel version. The preconditioner is only applied in the master processor.
+ *
+ * @param precond   functor returns M^(-1) * r, see IdentityPreconditioner
+ * @return  only return in proc 0 is valid
+ */
+template<typename MatrixType, typename VectorType, typename PreconditionerType>
+VectorType ConjugateGradientSolver(
+    const MatrixType &matrix_a,
+    const VectorType &b,
+    const VectorType &x0, //initial guess
+    const size_t max_iter,
+    const double tolerance,
+    const int residue_restart_step,
+    size_t &iter,    //return value
+    const boost::mpi::communicator &world,
+    const PreconditionerType &precond
 ) {
   if (world.rank() == kMasterProc) {
     return ConjugateGradientSolverMaster(
-        matrix_a, b, x0, max_iter, tolerance, residue_restart_step, iter, world
+        matrix_a, b, x0, max_iter, tolerance, residue_restart_step, iter, world, precond
     );
   } else {
     ConjugateGradientSolverSlave<MatrixType, VectorType>(
@@ -196,7 +234,7 @@ SlaveReceiveBroadcastInstruction(const boost::mpi::communicator world) {
   return instruction;
 }
 
-template<typename MatrixType, typename VectorType>
+template<typename MatrixType, typename VectorType, typename PreconditionerType>
 VectorType ConjugateGradientSolverMaster(
     const MatrixType &matrix_a,
     const VectorType &b,
@@ -205,7 +243,8 @@ VectorType ConjugateGradientSolverMaster(
     double tolerance,
     int residue_restart_step,
     size_t &iter,
-    const boost::mpi::communicator &world
+    const boost::mpi::communicator &world,
+    const PreconditionerType &precond
 ) {
   MasterBroadcastInstruction(start, world);
 
@@ -213,25 +252,26 @@ VectorType ConjugateGradientSolverMaster(
 
   VectorType ax0 = MatrixMultiplyVectorMaster(matrix_a, x0, world);
   VectorType r = b - ax0;
-  double rk_2norm = r.NormSquare();
-  if (rk_2norm < tol) {
+  double rkp1_2norm = r.NormSquare();
+  if (rkp1_2norm < tol) {
     iter = 0;
     MasterBroadcastInstruction(finish, world);
     return x0;
   }
-  VectorType p = r;
+  VectorType z = precond(r);
+  auto rz = r * z;  // = rk_2norm without preconditioner
+  VectorType p = z;
   VectorType x = x0;
-  double rkp1_2norm;
   for (size_t k = 0; k < max_iter; k++) {
     MasterBroadcastInstruction(multiplication, world);
     VectorType ap = MatrixMultiplyVectorMaster(matrix_a, p, world);
     auto pap = (p * ap);
-    auto alpha = rk_2norm / pap; //auto is double or complex
+    auto alpha = rz / pap; //auto is double or complex
 #ifndef NDEBUG
     assert(pap > 0);
     if (!std::isnormal(alpha)) {
       std::cout << "k : " << k << "\t pap : " << std::scientific << pap
-                << "\t rk_2norm : " << std::scientific << rk_2norm
+                << "\t rz : " << std::scientific << rz
                 << "\t alpha : " << std::scientific << alpha << std::endl;
       exit(1);
     }
@@ -252,22 +292,24 @@ VectorType ConjugateGradientSolverMaster(
       MasterBroadcastInstruction(finish, world);
       return x;
     }
-    double beta = rkp1_2norm / rk_2norm;
+    z = precond(r);
+    auto rz_new = r * z;
+    auto beta = rz_new / rz;
 #if VERBOSE_MODE == 1
     std::cout << "k = " << k << "\t residue norm = " << std::scientific << rkp1_2norm
                 << "\t beta = " << std::fixed << beta << "."
                 << std::endl;
 #endif
 #ifndef NDEBUG
-    if (beta > 1.0) {
+    if (std::abs(beta) > 1.0) {
       std::cout << "k = " << k << "\t residue norm = " << std::scientific << rkp1_2norm
                 << "\t pap = " << std::scientific << pap
                 << "\t beta = " << std::fixed << beta << "."
                 << std::endl;
     }
 #endif
-    p = r + beta * p;
-    rk_2norm = rkp1_2norm;
+    p = z + beta * p;
+    rz = rz_new;
   }
   iter = max_iter;
   std::cout << "warning: convergence may fail on gradient solving linear equation. rkp1_2norm = " << std::scientific
@@ -341,6 +383,99 @@ void MatrixMultiplyVectorSlave(
   //communicator, data, dest, tag
 }
 
+// virtual forward declaration for the AllReduce version
+// NB! user should define the following function by himself/herself
+//template<typename VectorType>
+//void CGSolverAllReduceVector(
+//    VectorType &v,        // in-place summation over all the processors
+//    const boost::mpi::communicator &world
+//);
+
+/**
+ * Parallel version in SPMD style. matrix_a is stored distributed in different processor, and
+ * matrix_a * v = sum over processors of the local matrix_a * v, which is combined by CGSolverAllReduceVector.
+ * All the processors hold x, r, p and do the same vector algebra,
+ * so there is no master bottleneck and no instruction broadcasting.
+ *
+ * @note b and x0 should be the same in all the processors.
+ * @return the solution, valid in all the processors
+ */
+template<typename MatrixType, typename VectorType>
+VectorType ConjugateGradientSolverAllReduce(
+    const MatrixType &matrix_a,
+    const VectorType &b,
+    const VectorType &x0, //initial guess
+    const size_t max_iter,
+    const double tolerance,
+    const int residue_restart_step,
+    size_t &iter,    //return value
+    const boost::mpi::communicator &world
+) {
+  return ConjugateGradientSolverAllReduce(matrix_a, b, x0, max_iter, tolerance, residue_restart_step, iter, world,
+                                          IdentityPreconditioner());
+}
+
+///< Preconditioned AllReduce version, the preconditioner is applied in all the processors.
+template<typename MatrixType, typename VectorType, typename PreconditionerType>
+VectorType ConjugateGradientSolverAllReduce(
+    const MatrixType &matrix_a,
+    const VectorType &b,
+    const VectorType &x0, //initial guess
+    const size_t max_iter,
+    const double tolerance,
+    const int residue_restart_step,
+    size_t &iter,    //return value
+    const boost::mpi::communicator &world,
+    const PreconditionerType &precond
+) {
+  double tol = b.NormSquare() * tolerance;
+
+  VectorType ax0 = matrix_a * x0;
+  CGSolverAllReduceVector(ax0, world); //defined by user
+  VectorType r = b - ax0;
+  double rkp1_2norm = r.NormSquare();
+  if (rkp1_2norm < tol) {
+    iter = 0;
+    return x0;
+  }
+  VectorType z = precond(r);
+  auto rz = r * z;
+  VectorType p = z;
+  VectorType x = x0;
+  for (size_t k = 0; k < max_iter; k++) {
+    VectorType ap = matrix_a * p;
+    CGSolverAllReduceVector(ap, world);
+    auto pap = (p * ap);
+    auto alpha = rz / pap; //auto is double or complex
+    x += alpha * p;
+
+    if (residue_restart_step > 0 && (k % residue_restart_step) == (residue_restart_step - 1)) {
+      VectorType ax = matrix_a * x;
+      CGSolverAllReduceVector(ax, world);
+      r = b - ax;
+    } else {
+      r += (-alpha) * ap;
+    }
+    rkp1_2norm = r.NormSquare();
+
+    if (rkp1_2norm < tol) {
+      iter = k + 1;
+      return x;
+    }
+    z = precond(r);
+    auto rz_new = r * z;
+    auto beta = rz_new / rz;
+    p = z + beta * p;
+    rz = rz_new;
+  }
+  iter = max_iter;
+  if (world.rank() == kMasterProc) {
+    std::cout << "warning: convergence may fail on gradient solving linear equation. rkp1_2norm = "
+              << std::scientific << rkp1_2norm << std::endl;
+  }
+  return x;
+}
+
 }//gqpeps
 
 #endif //GRACEQ_VMC_PEPS_CONJUGATE_GRADIENT_SOLVER_H
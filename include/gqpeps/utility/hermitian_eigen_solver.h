@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Dense Jacobi eigen solver for small Hermitian matrices.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_HERMITIAN_EIGEN_SOLVER_H
+#define GRACEQ_VMC_PEPS_HERMITIAN_EIGEN_SOLVER_H
+
+#include <stddef.h>   //size_t
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <numeric>    //iota
+#include <algorithm>  //sort
+#include "gqpeps/utility/conjugate_elem.h"    //ConjugateElem
+
+namespace gqpeps {
+
+inline double PhaseElem(const double a) { return a < 0.0 ? -1.0 : 1.0; }
+
+inline std::complex<double> PhaseElem(const std::complex<double> &a) {
+  const double abs = std::abs(a);
+  return abs > 0.0 ? a / abs : std::complex<double>(1.0);
+}
+
+/**
+ * Eigen decomposition A = V * diag(w) * V^dag of a n x n Hermitian matrix A by the cyclic Jacobi rotations.
+ * For the small matrices only, e.g. the eigenproblem of the Krylov subspace SR.
+ *
+ * @param a         row-major matrix A, only the Hermitian part is used. Destroyed.
+ * @param n
+ * @param eigvals   output, the eigenvalues in ascending order
+ * @param eigvecs   output, row-major, the j-th column eigvecs[k * n + j] is the eigenvector of eigvals[j]
+ * @return false if the rotations do not converge or A is not finite.
+ */
+template<typename ElemT>
+bool HermitianEigen(
+    std::vector<ElemT> &a,
+    const size_t n,
+    std::vector<double> &eigvals,
+    std::vector<ElemT> &eigvecs
+) {
+  std::vector<ElemT> v(n * n, ElemT(0));
+  double norm_sqr = 0.0;
+  for (size_t k = 0; k < n; k++) {
+    v[k * n + k] = ElemT(1);
+    for (size_t l = 0; l < n; l++) {
+      norm_sqr += std::norm(a[k * n + l]);
+    }
+  }
+  if (!std::isfinite(norm_sqr)) {
+    return false;
+  }
+  const size_t max_sweep = 100;
+  bool converged = false;
+  for (size_t sweep = 0; sweep < max_sweep; sweep++) {
+    double off_sqr = 0.0;
+    for (size_t p = 0; p < n; p++) {
+      for (size_t q = p + 1; q < n; q++) {
+        off_sqr += std::norm(a[p * n + q]);
+      }
+    }
+    if (off_sqr <= 1e-30 * norm_sqr) {
+      converged = true;
+      break;
+    }
+    for (size_t p = 0; p < n; p++) {
+      for (size_t q = p + 1; q < n; q++) {
+        const double apq = std::abs(a[p * n + q]);
+        if (apq == 0.0) {
+          continue;
+        }
+        // the phase turns a_pq real, then the real rotation of Numerical Recipes zeros it.
+        const ElemT phase = PhaseElem(a[p * n + q]);
+        const double app = std::real(a[p * n + p]), aqq = std::real(a[q * n + q]);
+        const double theta = (aqq - app) / (2.0 * apq);
+        const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+        const double c = 1.0 / std::sqrt(t * t + 1.0), s = t * c;
+        // A <- G^dag A G with G = diag(1, conj(phase)) on (p, q) times the rotation
+        for (size_t k = 0; k < n; k++) {
+          a[k * n + q] *= ConjugateElem(phase);
+          v[k * n + q] *= ConjugateElem(phase);
+        }
+        for (size_t k = 0; k < n; k++) {
+          a[q * n + k] *= phase;
+        }
+        for (size_t k = 0; k < n; k++) {
+          const ElemT akp = a[k * n + p], akq = a[k * n + q];
+          a[k * n + p] = c * akp - s * akq;
+          a[k * n + q] = s * akp + c * akq;
+          const ElemT vkp = v[k * n + p], vkq = v[k * n + q];
+          v[k * n + p] = c * vkp - s * vkq;
+          v[k * n + q] = s * vkp + c * vkq;
+        }
+        for (size_t k = 0; k < n; k++) {
+          const ElemT apk = a[p * n + k], aqk = a[q * n + k];
+          a[p * n + k] = c * apk - s * aqk;
+          a[q * n + k] = s * apk + c * aqk;
+        }
+      }
+    }
+  }
+  if (!converged) {
+    return false;
+  }
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&a, n](const size_t i, const size_t j) {
+    return std::real(a[i * n + i]) < std::real(a[j * n + j]);
+  });
+  eigvals.resize(n);
+  eigvecs.resize(n * n);
+  for (size_t j = 0; j < n; j++) {
+    eigvals[j] = std::real(a[order[j] * n + order[j]]);
+    for (size_t k = 0; k < n; k++) {
+      eigvecs[k * n + j] = v[k * n + order[j]];
+    }
+  }
+  return true;
+}
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_HERMITIAN_EIGEN_SOLVER_H
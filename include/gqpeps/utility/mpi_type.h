@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. MPI data types of the element types used in the raw MPI calls.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_MPI_TYPE_H
+#define GRACEQ_VMC_PEPS_MPI_TYPE_H
+
+#include <complex>
+#include <type_traits>
+#include "mpi.h"
+
+namespace gqpeps {
+
+template<typename T>
+struct MPITypeTraits {
+  static_assert(!std::is_same<T, T>::value, "No MPI data type for this element type.");
+};
+
+template<>
+struct MPITypeTraits<double> {
+  static MPI_Datatype Type(void) { return MPI_DOUBLE; }
+};
+
+template<>
+struct MPITypeTraits<std::complex<double>> {
+  static MPI_Datatype Type(void) { return MPI_DOUBLE_COMPLEX; }
+};
+
+template<>
+struct MPITypeTraits<int> {
+  static MPI_Datatype Type(void) { return MPI_INT; }
+};
+
+///< the MPI data type of T, e.g. MPIDataType<TenElemT>() for MPI_Allreduce of the tensor elements
+template<typename T>
+inline MPI_Datatype MPIDataType(void) {
+  return MPITypeTraits<T>::Type();
+}
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_MPI_TYPE_H
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Preemption signals and walltime budget of the job.
+*/
+
+#ifndef GRACEQ_VMC_PEPS_PREEMPTION_H
+#define GRACEQ_VMC_PEPS_PREEMPTION_H
+
+#include <csignal>
+#include <chrono>
+#include <limits>
+
+namespace gqpeps {
+
+inline volatile std::sig_atomic_t preemption_signal_received = 0;
+
+inline void PreemptionSignalHandler(int) {
+  preemption_signal_received = 1;
+}
+
+///< trap SIGTERM and SIGUSR1, which the job schedulers send some time before killing the job
+inline void TrapPreemptionSignals(void) {
+  std::signal(SIGTERM, PreemptionSignalHandler);
+  std::signal(SIGUSR1, PreemptionSignalHandler);
+}
+
+inline bool PreemptionSignalReceived(void) {
+  return preemption_signal_received != 0;
+}
+
+///< the walltime budget counted from the construction. budget <= 0 means no limit.
+class WalltimeBudget {
+ public:
+  WalltimeBudget(const double budget = 0.0) : budget_(budget), start_(std::chrono::steady_clock::now()) {}
+
+  bool Limited(void) const { return budget_ > 0.0; }
+
+  double Elapsed(void) const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  ///< seconds left, infinity if there is no limit
+  double Remaining(void) const {
+    return Limited() ? budget_ - Elapsed() : std::numeric_limits<double>::infinity();
+  }
+
+ private:
+  double budget_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}//gqpeps
+
+#endif //GRACEQ_VMC_PEPS_PREEMPTION_H
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the truncated SVD of the boundary MPS compressions.
+*/
+
+#include "gtest/gtest.h"
+#include "gqten/gqten.h"
+#include "gqpeps/ond_dim_tn/boundary_mps/truncated_svd.h"
+
+using namespace gqten;
+using namespace gqpeps;
+
+using gqten::special_qn::U1QN;
+using IndexT = Index<U1QN>;
+using QNSctT = QNSector<U1QN>;
+
+using DGQTensor = GQTensor<GQTEN_Double, U1QN>;
+
+struct TestTruncatedSVD : public testing::Test {
+  const U1QN qn0 = U1QN({QNCard("Sz", U1QNVal(0))});
+  const U1QN qn1 = U1QN({QNCard("Sz", U1QNVal(1))});
+  const U1QN qn2 = U1QN({QNCard("Sz", U1QNVal(2))});
+  IndexT idx_out = IndexT({QNSctT(qn0, 6), QNSctT(qn1, 6)}, GQTenIndexDirType::OUT);
+  IndexT idx_in = InverseIndex(idx_out);
+  // at most rank 1 in each of the 3 symmetry blocks of the bipartition (l1, l2 | r1, r2)
+  IndexT bond_out = IndexT({QNSctT(qn0, 1), QNSctT(qn1, 1), QNSctT(qn2, 1)}, GQTenIndexDirType::OUT);
+
+  DGQTensor low_rank_ten;   // (l1, l2, r1, r2)
+  DGQTensor full_rank_ten;
+
+  void SetUp(void) {
+    std::srand(0);
+    DGQTensor x({idx_in, idx_in, bond_out}), y({InverseIndex(bond_out), idx_out, idx_out});
+    x.Random(qn0);
+    y.Random(qn0);
+    Contract(&x, {2}, &y, {0}, &low_rank_ten);
+    full_rank_ten = DGQTensor({idx_in, idx_in, idx_out, idx_out});
+    full_rank_ten.Random(qn0);
+  }
+};
+
+///< || U S V^dag - A || / || A ||
+double RelativeReconstructionError(DGQTensor &a, DGQTensor &u, DGQTensor &s, DGQTensor &vt) {
+  DGQTensor us, usvt;
+  Contract(&u, {2}, &s, {0}, &us);
+  Contract(&us, {2}, &vt, {0}, &usvt);
+  DGQTensor diff = -a;
+  diff += usvt;
+  return diff.Get2Norm() / a.Get2Norm();
+}
+
+TEST_F(TestTruncatedSVD, LowRankRandomized) {
+  TruncatedSVDPara para;
+  para.scheme = RANDOMIZED_SVD;
+  para.oversampling = 4;
+  DGQTensor u, vt;
+  DGQTensor s;
+  double trunc_err;
+  size_t D;
+  // the sketch of 8 vectors in each of the blocks of the dimensions 36, 72, 36 is much smaller than the tensor
+  EXPECT_TRUE(TruncatedSVD(&low_rank_ten, 2, qn0, 1e-10, 1, 4, &u, &s, &vt, &trunc_err, &D, para));
+  EXPECT_EQ(D, size_t(3));
+  EXPECT_NEAR(trunc_err, 0.0, 1e-12);
+  EXPECT_NEAR(RelativeReconstructionError(low_rank_ten, u, s, vt), 0.0, 1e-10);
+}
+
+TEST_F(TestTruncatedSVD, Reproducible) {
+  TruncatedSVDPara para;
+  para.scheme = RANDOMIZED_SVD;
+  para.oversampling = 4;
+  DGQTensor u1, vt1, u2, vt2;
+  DGQTensor s1, s2;
+  double trunc_err1, trunc_err2;
+  size_t D1, D2;
+  ASSERT_TRUE(TruncatedSVD(&low_rank_ten, 2, qn0, 1e-10, 1, 4, &u1, &s1, &vt1, &trunc_err1, &D1, para));
+  std::srand(1); // the sketch does not depend on the global random state
+  ASSERT_TRUE(TruncatedSVD(&low_rank_ten, 2, qn0, 1e-10, 1, 4, &u2, &s2, &vt2, &trunc_err2, &D2, para));
+  EXPECT_EQ(D1, D2);
+  EXPECT_EQ(trunc_err1, trunc_err2);
+  EXPECT_TRUE(s1 == s2);
+  EXPECT_TRUE(u1 == u2);
+  EXPECT_TRUE(vt1 == vt2);
+}
+
+TEST_F(TestTruncatedSVD, GuardFallsBackToFullSVD) {
+  TruncatedSVDPara para;
+  para.scheme = RANDOMIZED_SVD;
+  para.oversampling = 0;
+  para.power_iter = 0;
+  // the sketch of 2 vectors in each block always misses some weight of the full rank tensor
+  para.guard_ratio = 0.0;
+  DGQTensor u, vt, u_full, vt_full;
+  DGQTensor s, s_full;
+  double trunc_err, trunc_err_full;
+  size_t D, D_full;
+  EXPECT_FALSE(TruncatedSVD(&full_rank_ten, 2, qn0, 1e-10, 1, 2, &u, &s, &vt, &trunc_err, &D, para));
+  SVD(&full_rank_ten, 2, qn0, 1e-10, 1, 2, &u_full, &s_full, &vt_full, &trunc_err_full, &D_full);
+  EXPECT_EQ(D, D_full);
+  EXPECT_DOUBLE_EQ(trunc_err, trunc_err_full);
+  EXPECT_TRUE(s == s_full);
+}
+
+TEST_F(TestTruncatedSVD, FullSVDScheme) {
+  TruncatedSVDPara para;
+  DGQTensor u, vt;
+  DGQTensor s;
+  double trunc_err;
+  size_t D;
+  EXPECT_FALSE(TruncatedSVD(&low_rank_ten, 2, qn0, 1e-10, 1, 4, &u, &s, &vt, &trunc_err, &D, para));
+  EXPECT_NEAR(RelativeReconstructionError(low_rank_ten, u, s, vt), 0.0, 1e-10);
+}
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the MPI functions of SplitIndexTPS.
+*/
+
+#include "gtest/gtest.h"
+#include "gqten/gqten.h"
+#include "gqpeps/two_dim_tn/tps/split_index_tps.h"
+
+using namespace gqten;
+using namespace gqpeps;
+
+using gqten::special_qn::U1QN;
+using QNT = U1QN;
+using IndexT = Index<U1QN>;
+using QNSctT = QNSector<U1QN>;
+using Tensor = GQTensor<GQTEN_Double, U1QN>;
+using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+
+struct TestSplitIndexTPSMPI : public testing::Test {
+  boost::mpi::communicator world;
+  size_t Lx = 3;
+  size_t Ly = 2;
+  size_t phy_dim = 2;
+
+  QNT qn0 = QNT({QNCard("N", U1QNVal(0))});
+  QNT qn1 = QNT({QNCard("N", U1QNVal(1))});
+  IndexT idx_out = IndexT({QNSctT(qn0, 2), QNSctT(qn1, 3)}, GQTenIndexDirType::OUT);
+  IndexT idx_in = InverseIndex(idx_out);
+
+  void SetUp(void) {
+    ::testing::TestEventListeners &listeners =
+        ::testing::UnitTest::GetInstance()->listeners();
+    if (world.rank() != 0) {
+      delete listeners.Release(listeners.default_result_printer());
+    }
+  }
+
+  SITPST FilledSITPS(const double value) {
+    SITPST sitps(Ly, Lx, phy_dim);
+    for (size_t row = 0; row < Ly; row++) {
+      for (size_t col = 0; col < Lx; col++) {
+        for (size_t compt = 0; compt < phy_dim; compt++) {
+          Tensor ten({idx_in, idx_out});
+          ten.Fill(qn0, value + compt);
+          sitps({row, col})[compt] = ten;
+        }
+      }
+    }
+    return sitps;
+  }
+
+  void ExpectEqual(const SITPST &lhs, const SITPST &rhs) {
+    for (size_t row = 0; row < Ly; row++) {
+      for (size_t col = 0; col < Lx; col++) {
+        for (size_t compt = 0; compt < phy_dim; compt++) {
+          Tensor diff = lhs({row, col})[compt] + (-1.0) * rhs({row, col})[compt];
+          EXPECT_NEAR(diff.Get2Norm(), 0.0, 1e-13);
+        }
+      }
+    }
+  }
+};
+
+TEST_F(TestSplitIndexTPSMPI, MeanReduceToMaster) {
+  SITPST sitps1 = FilledSITPS(world.rank());
+  SITPST sitps2 = FilledSITPS(2.0 * world.rank());
+  MPIMeanSplitIndexTPS<GQTEN_Double, U1QN>({&sitps1, &sitps2}, world, false);
+  if (world.rank() == kMasterProc) {
+    const double mean = double(world.size() - 1) / 2.0;
+    ExpectEqual(sitps1, FilledSITPS(mean));
+    ExpectEqual(sitps2, FilledSITPS(2.0 * mean));
+  }
+}
+
+TEST_F(TestSplitIndexTPSMPI, MeanAllReduce) {
+  SITPST sitps = FilledSITPS(world.rank());
+  MPIMeanSplitIndexTPS<GQTEN_Double, U1QN>({&sitps}, world, true);
+  const double mean = double(world.size() - 1) / 2.0;
+  ExpectEqual(sitps, FilledSITPS(mean));
+}
+
+TEST_F(TestSplitIndexTPSMPI, BroadCastData) {
+  SITPST sitps = FilledSITPS(1.0);
+  const std::vector<size_t> signature = DataSizeSignature(sitps);
+  if (world.rank() == kMasterProc) {
+    sitps += 2.0 * FilledSITPS(2.0);
+    EXPECT_EQ(DataSizeSignature(sitps), signature);
+  }
+  BroadCastSplitIndexTPSData(sitps, world);
+  ExpectEqual(sitps, FilledSITPS(1.0) + 2.0 * FilledSITPS(2.0));
+}
+
+TEST_F(TestSplitIndexTPSMPI, Checksum) {
+  SITPST sitps = FilledSITPS(1.0);
+  unsigned long long checksum = SplitIndexTPSChecksum(sitps), min_checksum, max_checksum;
+  ::MPI_Allreduce(&checksum, &min_checksum, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, MPI_Comm(world));
+  ::MPI_Allreduce(&checksum, &max_checksum, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_Comm(world));
+  EXPECT_EQ(min_checksum, max_checksum);
+  EXPECT_EQ(SplitIndexTPSChecksum(sitps), SplitIndexTPSChecksum(FilledSITPS(1.0)));
+  EXPECT_NE(SplitIndexTPSChecksum(sitps), SplitIndexTPSChecksum(FilledSITPS(1.0 + 1e-15)));
+}
+
+int main(int argc, char *argv[]) {
+  boost::mpi::environment env;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
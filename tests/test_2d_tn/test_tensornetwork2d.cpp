@@ -45,6 +45,7 @@ struct TestSpin2DTensorNetwork : public testing::Test {
 
   Configuration config = Configuration(Ly, Lx);
 
+  SplitIndexTPS<GQTEN_Double, U1QN> split_index_tps = SplitIndexTPS<GQTEN_Double, U1QN>(Ly, Lx);
   TensorNetwork2D<GQTEN_Double, U1QN> tn2d = TensorNetwork2D<GQTEN_Double, U1QN>(Ly, Lx);
 
   BMPSTruncatePara trunc_para = BMPSTruncatePara(4, 8, 1e-12, VARIATION2Site);
@@ -55,7 +56,7 @@ struct TestSpin2DTensorNetwork : public testing::Test {
 //    gqten::hp_numeric::SetTensorTransposeNumThreads(1);
     tps.Load("tps_heisenberg_D4");
 
-    SplitIndexTPS<GQTEN_Double, U1QN> split_index_tps(tps);
+    split_index_tps = SplitIndexTPS<GQTEN_Double, U1QN>(tps);
     for (size_t i = 0; i < Lx; i++) { //col index
       for (size_t j = 0; j < Ly; j++) { //row index
         config({j, i}) = (i + j) % 2;
@@ -108,6 +109,46 @@ TEST_F(TestSpin2DTensorNetwork, HeisenbergD4NNTraceBMPSSingleSiteVariationUpdate
   EXPECT_NEAR(psi_c, psi_d, 1e-15);
 }
 
+TEST_F(TestSpin2DTensorNetwork, HeisenbergD4WarmStartBMPS) {
+  trunc_para.warm_start = true;
+  EXPECT_EQ(trunc_para.ConvergenceTol(), 1e-10);
+  tn2d.GrowBMPSForRow(2, trunc_para);
+  tn2d.InitBTen(BTenPOSITION::LEFT, 2);
+  tn2d.GrowFullBTen(BTenPOSITION::RIGHT, 2, 2, true);
+  double psi_a = tn2d.Trace({2, 0}, HORIZONTAL);
+  EXPECT_EQ(tn2d.GetBMPSCompressStatistics().warm_start_num, size_t(0));
+
+  // the same network again, the boundary MPS of the last sweep are the converged results
+  tn2d.DeleteInnerBMPS(UP);
+  tn2d.DeleteInnerBMPS(DOWN);
+  tn2d.ClearBMPSCompressStatistics();
+  tn2d.GrowBMPSForRow(2, trunc_para);
+  tn2d.InitBTen(BTenPOSITION::LEFT, 2);
+  tn2d.GrowFullBTen(BTenPOSITION::RIGHT, 2, 2, true);
+  double psi_b = tn2d.Trace({2, 0}, HORIZONTAL);
+  EXPECT_NEAR(psi_a, psi_b, 1e-12);
+  const BMPSCompressStatistics &stat = tn2d.GetBMPSCompressStatistics();
+  EXPECT_EQ(stat.warm_start_num, stat.compress_num);
+  EXPECT_EQ(stat.one_sweep_num, stat.compress_num);
+}
+
+TEST_F(TestSpin2DTensorNetwork, HeisenbergD4RandomizedSVDBMPS) {
+  TensorNetwork2D<GQTEN_Double, U1QN> tn2d_rsvd = tn2d;
+  tn2d.GrowBMPSForRow(2, trunc_para);
+  tn2d.InitBTen(BTenPOSITION::LEFT, 2);
+  tn2d.GrowFullBTen(BTenPOSITION::RIGHT, 2, 2, true);
+  double psi_a = tn2d.Trace({2, 0}, HORIZONTAL);
+
+  trunc_para.svd_para.scheme = RANDOMIZED_SVD;
+  trunc_para.svd_para.oversampling = 0;
+  tn2d_rsvd.GrowBMPSForRow(2, trunc_para);
+  tn2d_rsvd.InitBTen(BTenPOSITION::LEFT, 2);
+  tn2d_rsvd.GrowFullBTen(BTenPOSITION::RIGHT, 2, 2, true);
+  double psi_b = tn2d_rsvd.Trace({2, 0}, HORIZONTAL);
+  std::cout << "Amplitude by full SVD = " << psi_a << ", by randomized SVD = " << psi_b << std::endl;
+  EXPECT_NEAR(psi_a, psi_b, 1e-6 * std::abs(psi_a));
+}
+
 TEST_F(TestSpin2DTensorNetwork, HeisenbergD4BTen2Trace) {
   /***** HORIZONTAL MPS *****/
   tn2d.GrowBMPSForRow(1, trunc_para);
@@ -178,4 +219,48 @@ TEST_F(TestSpin2DTensorNetwork, HeisenbergD4BTen2Trace) {
     EXPECT_NEAR(psi[0], psi[i], 1e-15);
   }
   tn2d.BTen2MoveStep(BTenPOSITION::DOWN, 1);
-}
\ No newline at end of file
+}
+
+/**
+ * The vertical bonds traced by the two-row environments of the horizontal boundary MPS
+ * agree with the ones traced by the vertical boundary MPS, for the exchanged spins on every vertical bond.
+ * The boundary MPS are not truncated, D_max = D^2.
+ */
+TEST_F(TestSpin2DTensorNetwork, HeisenbergD4NNTraceByBTen2) {
+  trunc_para.D_max = 16;
+  TensorNetwork2D<GQTEN_Double, U1QN> tn2d_col = tn2d;
+  std::vector<double> psi_row((Ly - 1) * Lx), psi_col((Ly - 1) * Lx);
+  for (size_t row = 0; row < Ly - 1; row++) {
+    tn2d.GrowBMPSForRow(row, trunc_para);
+    tn2d.InitBTen2(BTenPOSITION::LEFT, row);
+    tn2d.GrowFullBTen2(BTenPOSITION::RIGHT, row, 1, true);
+    for (size_t col = 0; col < Lx; col++) {
+      const SiteIdx site1 = {row, col};
+      const SiteIdx site2 = {row + 1, col};
+      psi_row[row * Lx + col] = tn2d.ReplaceNNSiteTraceByBTen2(site1, site2,
+                                                               split_index_tps(site1)[config(site2)],
+                                                               split_index_tps(site2)[config(site1)]);
+      if (col < Lx - 1) {
+        tn2d.BTen2MoveStep(BTenPOSITION::RIGHT, row);
+      }
+    }
+  }
+  for (size_t col = 0; col < Lx; col++) {
+    tn2d_col.GrowBMPSForCol(col, trunc_para);
+    tn2d_col.InitBTen(BTenPOSITION::UP, col);
+    tn2d_col.GrowFullBTen(BTenPOSITION::DOWN, col, 2, true);
+    for (size_t row = 0; row < Ly - 1; row++) {
+      const SiteIdx site1 = {row, col};
+      const SiteIdx site2 = {row + 1, col};
+      psi_col[row * Lx + col] = tn2d_col.ReplaceNNSiteTrace(site1, site2, VERTICAL,
+                                                            split_index_tps(site1)[config(site2)],
+                                                            split_index_tps(site2)[config(site1)]);
+      if (row < Ly - 2) {
+        tn2d_col.BTenMoveStep(BTenPOSITION::DOWN);
+      }
+    }
+  }
+  for (size_t i = 0; i < psi_row.size(); i++) {
+    EXPECT_NEAR(psi_row[i], psi_col[i], 1e-10 * std::abs(psi_col[i])) << "bond " << i;
+  }
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the subspace eigenproblem of the Krylov subspace SR.
+*/
+
+#include <cmath>
+#include <random>
+#include "gtest/gtest.h"
+#include "gqpeps/algorithm/vmc_update/krylov_subspace_sr.h"
+#include "gqpeps/utility/cholesky_solver.h"
+
+using namespace gqpeps;
+
+template<typename ElemT>
+ElemT RandomElem(std::mt19937 &engine, const double scale);
+
+template<>
+double RandomElem<double>(std::mt19937 &engine, const double scale) {
+  return std::normal_distribution<double>(0.0, scale)(engine);
+}
+
+template<>
+std::complex<double> RandomElem<std::complex<double>>(std::mt19937 &engine, const double scale) {
+  std::normal_distribution<double> normal(0.0, scale);
+  return std::complex<double>(normal(engine), normal(engine));
+}
+
+/**
+ * Synthetic samples of the directional log-derivatives x_l(S) and the real local energies correlated with them,
+ * and the subspace matrices computed directly from the samples.
+ */
+template<typename ElemT>
+struct SyntheticSamples {
+  size_t n;
+  std::vector<std::vector<ElemT>> xs;
+  std::vector<ElemT> energies;
+  ElemT e;
+  std::vector<ElemT> s_mat, h_mat, h_k0;  // centered, H is Hermitian
+
+  SyntheticSamples(const size_t n, const size_t sample_num, const unsigned seed) : n(n) {
+    std::mt19937 engine(seed);
+    std::vector<ElemT> coupling(n);
+    for (auto &elem : coupling) {
+      elem = RandomElem<ElemT>(engine, 1.0);
+    }
+    for (size_t i = 0; i < sample_num; i++) {
+      std::vector<ElemT> x(n);
+      double energy = -1.0 + RandomElem<double>(engine, 0.1);
+      for (size_t l = 0; l < n; l++) {
+        x[l] = RandomElem<ElemT>(engine, 1.0 + l);
+        energy += 0.1 * std::real(coupling[l] * x[l]);
+      }
+      xs.push_back(x);
+      energies.push_back(energy);
+    }
+    e = Mean_(energies);
+    std::vector<ElemT> x_ave(n, ElemT(0));
+    for (const auto &x : xs) {
+      for (size_t l = 0; l < n; l++) {
+        x_ave[l] += x[l] / double(sample_num);
+      }
+    }
+    s_mat.assign(n * n, ElemT(0));
+    h_mat.assign(n * n, ElemT(0));
+    h_k0.assign(n, ElemT(0));
+    for (size_t i = 0; i < sample_num; i++) {
+      for (size_t k = 0; k < n; k++) {
+        const ElemT dxk = ConjugateElem(xs[i][k] - x_ave[k]);
+        h_k0[k] += dxk * energies[i] / double(sample_num);
+        for (size_t l = 0; l < n; l++) {
+          const ElemT dxl = xs[i][l] - x_ave[l];
+          s_mat[k * n + l] += dxk * dxl / double(sample_num);
+          h_mat[k * n + l] += dxk * energies[i] * dxl / double(sample_num);
+        }
+      }
+    }
+  }
+
+  KrylovSRSubspace<ElemT> Subspace(void) const {
+    KrylovSRSubspace<ElemT> lm(n);
+    for (size_t i = 0; i < xs.size(); i++) {
+      lm.AddSample(energies[i], xs[i]);
+    }
+    return lm;
+  }
+
+ private:
+  static ElemT Mean_(const std::vector<ElemT> &v) {
+    ElemT sum(0);
+    for (const auto &elem : v) {
+      sum += elem;
+    }
+    return sum / double(v.size());
+  }
+};
+
+///< for a large shift, the step is the stochastic reconfiguration step of length 1 / shift
+template<typename ElemT>
+void CheckSmallStepAgreesWithSR(void) {
+  const size_t n = 3;
+  const SyntheticSamples<ElemT> samples(n, 200, 1);
+  const double shift = 1e6;
+  std::vector<ElemT> param_change;
+  double energy;
+  ASSERT_TRUE(samples.Subspace().Solve(shift, 0.5, param_change, energy));
+  std::vector<ElemT> a = samples.s_mat, sr_step = samples.h_k0;
+  ASSERT_TRUE(CholeskySolve(a, sr_step, n));
+  double sr_norm_sqr = 0.0;
+  for (size_t k = 0; k < n; k++) {
+    sr_norm_sqr += std::norm(sr_step[k]);
+  }
+  for (size_t k = 0; k < n; k++) {
+    EXPECT_NEAR(std::abs(shift * param_change[k] + sr_step[k]), 0.0, 1e-4 * std::sqrt(sr_norm_sqr));
+  }
+  EXPECT_LT(energy, std::real(samples.e));
+}
+
+TEST(TestKrylovSRSubspace, SmallStepAgreesWithSR) {
+  CheckSmallStepAgreesWithSR<double>();
+  CheckSmallStepAgreesWithSR<std::complex<double>>();
+}
+
+/**
+ * Without the shift and the normalization (xi = 1), c solves the eigenproblem
+ *      H_k0 + sum_l (H_kl - lambda S_kl) c_l = 0,   lambda = E + sum_l H_k0^* c_l,
+ * and lambda is the lowest root, i.e. not above the Rayleigh quotient of any vector.
+ */
+template<typename ElemT>
+void CheckLowestRoot(void) {
+  const size_t n = 4;
+  const SyntheticSamples<ElemT> samples(n, 100, 2);
+  std::vector<ElemT> c;
+  double energy;
+  ASSERT_TRUE(samples.Subspace().Solve(0.0, 1.0, c, energy));
+  ElemT lambda = samples.e;
+  for (size_t l = 0; l < n; l++) {
+    lambda += ConjugateElem(samples.h_k0[l]) * c[l];
+  }
+  EXPECT_NEAR(std::abs(lambda - energy), 0.0, 1e-10);
+  for (size_t k = 0; k < n; k++) {
+    ElemT residual = samples.h_k0[k];
+    for (size_t l = 0; l < n; l++) {
+      residual += (samples.h_mat[k * n + l] - energy * samples.s_mat[k * n + l]) * c[l];
+    }
+    EXPECT_NEAR(std::abs(residual), 0.0, 1e-10);
+  }
+
+  std::mt19937 engine(3);
+  for (size_t trial = 0; trial < 1000; trial++) {
+    std::vector<ElemT> v(n + 1);
+    for (auto &elem : v) {
+      elem = RandomElem<ElemT>(engine, 1.0);
+    }
+    // H = [[E, h^dag], [h, H_kl]], S = [[1, 0], [0, S_kl]]
+    ElemT vhv = std::norm(v[0]) * samples.e, vsv = std::norm(v[0]);
+    for (size_t k = 0; k < n; k++) {
+      vhv += 2.0 * std::real(ConjugateElem(v[k + 1]) * samples.h_k0[k] * v[0]);
+      for (size_t l = 0; l < n; l++) {
+        vhv += ConjugateElem(v[k + 1]) * samples.h_mat[k * n + l] * v[l + 1];
+        vsv += ConjugateElem(v[k + 1]) * samples.s_mat[k * n + l] * v[l + 1];
+      }
+    }
+    EXPECT_LE(energy, std::real(vhv / vsv) + 1e-12);
+  }
+}
+
+TEST(TestKrylovSRSubspace, LowestRoot) {
+  CheckLowestRoot<double>();
+  CheckLowestRoot<std::complex<double>>();
+}
+
+///< xi = 0 divides the linear coefficients by D^2 = 1 + c^dag S c
+TEST(TestKrylovSRSubspace, Normalization) {
+  const size_t n = 2;
+  const SyntheticSamples<double> samples(n, 100, 4);
+  const KrylovSRSubspace<double> lm = samples.Subspace();
+  std::vector<double> c, dp;
+  double energy, energy_normalized;
+  ASSERT_TRUE(lm.Solve(0.1, 1.0, c, energy));
+  ASSERT_TRUE(lm.Solve(0.1, 0.0, dp, energy_normalized));
+  EXPECT_DOUBLE_EQ(energy, energy_normalized);
+  double d_sqr = 1.0;
+  for (size_t k = 0; k < n; k++) {
+    for (size_t l = 0; l < n; l++) {
+      d_sqr += c[k] * samples.s_mat[k * n + l] * c[l];
+    }
+  }
+  for (size_t k = 0; k < n; k++) {
+    EXPECT_NEAR(dp[k], c[k] / d_sqr, 1e-12);
+  }
+}
+
+///< the linearly dependent directions are dropped by the canonical orthogonalization
+TEST(TestKrylovSRSubspace, DependentDirections) {
+  const SyntheticSamples<double> samples(1, 100, 5);
+  KrylovSRSubspace<double> lm(1), lm_doubled(2);
+  for (size_t i = 0; i < samples.xs.size(); i++) {
+    lm.AddSample(samples.energies[i], samples.xs[i]);
+    lm_doubled.AddSample(samples.energies[i], {samples.xs[i][0], 2.0 * samples.xs[i][0]});
+  }
+  std::vector<double> dp, dp_doubled;
+  double energy, energy_doubled;
+  ASSERT_TRUE(lm.Solve(0.1, 0.5, dp, energy));
+  ASSERT_TRUE(lm_doubled.Solve(0.1, 0.5, dp_doubled, energy_doubled));
+  EXPECT_NEAR(energy, energy_doubled, 1e-10);
+  EXPECT_NEAR(dp[0], dp_doubled[0] + 2.0 * dp_doubled[1], 1e-10);
+}
+
+TEST(TestKrylovSRSubspace, NoSample) {
+  KrylovSRSubspace<double> lm(2);
+  std::vector<double> param_change;
+  double energy;
+  EXPECT_FALSE(lm.Solve(0.0, 0.5, param_change, energy));
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the momentum and Adam optimizers.
+*/
+
+#include <filesystem>
+#include "gtest/gtest.h"
+#include "gqten/gqten.h"
+#include "gqpeps/algorithm/vmc_update/momentum_optimizer.h"
+
+using namespace gqten;
+using namespace gqpeps;
+
+using gqten::special_qn::U1QN;
+using QNT = U1QN;
+using IndexT = Index<U1QN>;
+using QNSctT = QNSector<U1QN>;
+using Tensor = GQTensor<GQTEN_Double, U1QN>;
+using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+
+struct TestMomentumOptimizer : public testing::Test {
+  size_t Lx = 3;
+  size_t Ly = 2;
+  size_t phy_dim = 2;
+
+  QNT qn0 = QNT({QNCard("N", U1QNVal(0))});
+  QNT qn1 = QNT({QNCard("N", U1QNVal(1))});
+  IndexT idx_out = IndexT({QNSctT(qn0, 2), QNSctT(qn1, 3)}, GQTenIndexDirType::OUT);
+  IndexT idx_in = InverseIndex(idx_out);
+  std::vector<QNT> compt_div = {qn0, qn1};
+
+  SITPST RandomGradient(void) {
+    SITPST grad(Ly, Lx, phy_dim);
+    for (size_t row = 0; row < Ly; row++) {
+      for (size_t col = 0; col < Lx; col++) {
+        for (size_t compt = 0; compt < phy_dim; compt++) {
+          Tensor ten({idx_in, idx_out, idx_in, idx_out});
+          ten.Random(compt_div[compt]);
+          grad({row, col})[compt] = ten;
+        }
+      }
+    }
+    return grad;
+  }
+};
+
+TEST_F(TestMomentumOptimizer, Momentum) {
+  MomentumOptimizer<GQTEN_Double, U1QN> optimizer;
+  const double mu = 0.5;
+  SITPST g0 = RandomGradient(), g1 = RandomGradient();
+  SITPST d0 = optimizer.MomentumDirection(g0, mu, false);
+  EXPECT_NEAR((d0 + (-1.0) * g0).NormSquare(), 0.0, 1e-13);
+  SITPST d1 = optimizer.MomentumDirection(g1, mu, false);
+  EXPECT_NEAR((d1 + (-1.0) * (g1 + mu * g0)).NormSquare(), 0.0, 1e-13);
+  EXPECT_EQ(optimizer.Step(), 2);
+
+  MomentumOptimizer<GQTEN_Double, U1QN> nesterov;
+  nesterov.MomentumDirection(g0, mu, true);
+  SITPST n1 = nesterov.MomentumDirection(g1, mu, true);
+  EXPECT_NEAR((n1 + (-1.0) * (g1 + mu * (g1 + mu * g0))).NormSquare(), 0.0, 1e-13);
+}
+
+TEST_F(TestMomentumOptimizer, AdamFirstStepIsSign) {
+  MomentumOptimizer<GQTEN_Double, U1QN> optimizer;
+  SITPST g = RandomGradient();
+  SITPST d = optimizer.AdamDirection(g, 0.9, 0.999, 0.0);
+  for (size_t row = 0; row < Ly; row++) {
+    for (size_t col = 0; col < Lx; col++) {
+      for (size_t compt = 0; compt < phy_dim; compt++) {
+        const Tensor &g_ten = g({row, col})[compt];
+        const GQTEN_Double *g_data = g_ten.GetRawDataPtr();
+        const GQTEN_Double *d_data = d({row, col})[compt].GetRawDataPtr();
+        for (size_t i = 0; i < g_ten.GetActualDataSize(); i++) {
+          EXPECT_NEAR(d_data[i], g_data[i] > 0 ? 1.0 : -1.0, 1e-12);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestMomentumOptimizer, DumpLoad) {
+  MomentumOptimizer<GQTEN_Double, U1QN> optimizer;
+  SITPST g0 = RandomGradient(), g1 = RandomGradient();
+  optimizer.AdamDirection(g0, 0.9, 0.999, 1e-8);
+  optimizer.Dump("test_momentum_optimizer_state");
+
+  MomentumOptimizer<GQTEN_Double, U1QN> loaded;
+  ASSERT_TRUE(loaded.Load("test_momentum_optimizer_state", Ly, Lx));
+  EXPECT_EQ(loaded.Step(), 1);
+  SITPST d = optimizer.AdamDirection(g1, 0.9, 0.999, 1e-8);
+  SITPST d_loaded = loaded.AdamDirection(g1, 0.9, 0.999, 1e-8);
+  EXPECT_NEAR((d + (-1.0) * d_loaded).NormSquare(), 0.0, 1e-13);
+
+  MomentumOptimizer<GQTEN_Double, U1QN> missing;
+  EXPECT_FALSE(missing.Load("test_momentum_optimizer_no_state", Ly, Lx));
+  EXPECT_TRUE(missing.Empty());
+  std::filesystem::remove_all("test_momentum_optimizer_state");
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the packed O matrix in stochastic reconfiguration.
+*/
+
+#include "gtest/gtest.h"
+#include "gqten/gqten.h"
+#include "gqpeps/algorithm/vmc_update/packed_o_matrix.h"
+
+using namespace gqten;
+using namespace gqpeps;
+
+using gqten::special_qn::U1QN;
+using QNT = U1QN;
+using IndexT = Index<U1QN>;
+using QNSctT = QNSector<U1QN>;
+using Tensor = GQTensor<GQTEN_Double, U1QN>;
+using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+
+struct TestPackedOMatrix : public testing::Test {
+  size_t Lx = 3;
+  size_t Ly = 2;
+  size_t phy_dim = 2;
+  size_t sample_num = 5;
+
+  QNT qn0 = QNT({QNCard("N", U1QNVal(0))});
+  QNT qn1 = QNT({QNCard("N", U1QNVal(1))});
+  IndexT idx_out = IndexT({QNSctT(qn0, 2), QNSctT(qn1, 3)}, GQTenIndexDirType::OUT);
+  IndexT idx_in = InverseIndex(idx_out);
+  std::vector<QNT> compt_div = {qn0, qn1};
+
+  Tensor ComptTensor(const size_t compt, const bool random) {
+    Tensor ten({idx_in, idx_out, idx_in, idx_out});
+    if (random) {
+      ten.Random(compt_div[compt]);
+    } else {
+      ten.Fill(compt_div[compt], 0.0);
+    }
+    return ten;
+  }
+
+  SITPST Layout(void) {
+    SITPST layout(Ly, Lx, phy_dim);
+    for (size_t row = 0; row < Ly; row++) {
+      for (size_t col = 0; col < Lx; col++) {
+        for (size_t compt = 0; compt < phy_dim; compt++) {
+          layout({row, col})[compt] = ComptTensor(compt, false);
+        }
+      }
+    }
+    return layout;
+  }
+
+  void FillSamples(PackedOMatrix<GQTEN_Double, U1QN> &o_matrix, std::vector<SITPST> &samples) {
+    o_matrix.Initialize(Layout(), sample_num);
+    for (size_t i = 0; i < sample_num; i++) {
+      SITPST sample(Ly, Lx, phy_dim);
+      size_t sample_idx = o_matrix.AppendSample();
+      for (size_t row = 0; row < Ly; row++) {
+        for (size_t col = 0; col < Lx; col++) {
+          size_t compt = std::rand() % phy_dim;
+          sample({row, col})[compt] = ComptTensor(compt, true);
+          o_matrix.SetSiteData(sample_idx, {row, col}, compt, sample({row, col})[compt]);
+        }
+      }
+      samples.push_back(sample);
+    }
+  }
+};
+
+TEST_F(TestPackedOMatrix, MultiplyOOdag) {
+  std::srand(0);
+  PackedOMatrix<GQTEN_Double, U1QN> o_matrix;
+  std::vector<SITPST> samples;
+  FillSamples(o_matrix, samples);
+  EXPECT_EQ(o_matrix.SampleNum(), sample_num);
+
+  SITPST v(Ly, Lx, phy_dim);
+  for (size_t row = 0; row < Ly; row++) {
+    for (size_t col = 0; col < Lx; col++) {
+      for (size_t compt = 0; compt < phy_dim; compt++) {
+        v({row, col})[compt] = ComptTensor(compt, true);
+      }
+    }
+  }
+
+  SITPST expected = samples[0] * (samples[0] * v);
+  for (size_t i = 1; i < sample_num; i++) {
+    expected += samples[i] * (samples[i] * v);
+  }
+
+  std::vector<GQTEN_Double> v_flat, res_flat;
+  o_matrix.Flatten(v, v_flat);
+  EXPECT_EQ(v_flat.size(), o_matrix.ParamSize());
+  o_matrix.MultiplyOOdag(v_flat, res_flat);
+  SITPST res = o_matrix.Unflatten(res_flat);
+  SITPST diff = res - expected;
+  EXPECT_NEAR(diff.NormSquare(), 0.0, 1e-20);
+}
+
+TEST_F(TestPackedOMatrix, DiagonalAndBlocks) {
+  std::srand(1);
+  PackedOMatrix<GQTEN_Double, U1QN> o_matrix;
+  std::vector<SITPST> samples;
+  FillSamples(o_matrix, samples);
+  const size_t param_size = o_matrix.ParamSize();
+  std::vector<double> diag(param_size, 0.0);
+  o_matrix.AccumulateSquareDiagonal(diag);
+
+  // columns of O^T O^* by the multiplication on the unit vectors
+  auto column = [&](const size_t l) {
+    std::vector<GQTEN_Double> e(param_size, 0.0), res;
+    e[l] = 1.0;
+    o_matrix.MultiplyOOdag(e, res);
+    return res;
+  };
+  for (size_t k = 0; k < param_size; k += 37) {
+    EXPECT_NEAR(diag[k], column(k)[k], 1e-12);
+  }
+
+  const size_t site = 1;
+  for (size_t compt = 0; compt < phy_dim; compt++) {
+    const size_t n = o_matrix.ComponentSize(site, compt);
+    const size_t offset = o_matrix.ComponentOffset(site, compt);
+    std::vector<GQTEN_Double> block(n * n, 0.0);
+    o_matrix.AccumulateComponentBlock(site, compt, block.data());
+    for (size_t l = 0; l < n; l += 11) {
+      auto col = column(offset + l);
+      for (size_t k = 0; k < n; k++) {
+        EXPECT_NEAR(block[k * n + l], col[offset + k], 1e-12);
+      }
+    }
+  }
+}
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the preconditioners of stochastic reconfiguration,
+* compared with the dense solve of the S matrix.
+*/
+
+#include "gtest/gtest.h"
+#include "gqten/gqten.h"
+#include "gqpeps/algorithm/vmc_update/stochastic_reconfiguration_preconditioner.h"
+
+using namespace gqten;
+using namespace gqpeps;
+
+using gqten::special_qn::U1QN;
+using QNT = U1QN;
+using IndexT = Index<U1QN>;
+using QNSctT = QNSector<U1QN>;
+using Tensor = GQTensor<GQTEN_Double, U1QN>;
+using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+
+struct TestSRPreconditioner : public testing::Test {
+  boost::mpi::communicator world;
+  size_t Lx = 2;
+  size_t Ly = 2;
+  size_t phy_dim = 2;
+  size_t sample_num = 20;
+  double diag_shift = 1e-3;
+
+  QNT qn0 = QNT({QNCard("N", U1QNVal(0))});
+  QNT qn1 = QNT({QNCard("N", U1QNVal(1))});
+  IndexT idx_out = IndexT({QNSctT(qn0, 1), QNSctT(qn1, 2)}, GQTenIndexDirType::OUT);
+  IndexT idx_in = InverseIndex(idx_out);
+  std::vector<QNT> compt_div = {qn0, qn1};
+
+  PackedOMatrix<GQTEN_Double, U1QN> o_matrix;
+  SITPST gten_ave;
+  size_t param_size;
+  std::vector<double> s_dense;  // S = <O^* O^T> - <O^*><O^*>^dag + diag_shift, in all the processors
+
+  Tensor ComptTensor(const size_t compt, const bool random) {
+    Tensor ten({idx_in, idx_out, idx_in, idx_out});
+    if (random) {
+      ten.Random(compt_div[compt]);
+    } else {
+      ten.Fill(compt_div[compt], 0.0);
+    }
+    return ten;
+  }
+
+  void SetUp(void) override {
+    std::srand(world.rank() + 1);
+    SITPST layout(Ly, Lx, phy_dim);
+    for (size_t row = 0; row < Ly; row++) {
+      for (size_t col = 0; col < Lx; col++) {
+        for (size_t compt = 0; compt < phy_dim; compt++) {
+          layout({row, col})[compt] = ComptTensor(compt, false);
+        }
+      }
+    }
+    o_matrix.Initialize(layout, sample_num);
+    for (size_t i = 0; i < sample_num; i++) {
+      size_t sample_idx = o_matrix.AppendSample();
+      for (size_t row = 0; row < Ly; row++) {
+        for (size_t col = 0; col < Lx; col++) {
+          size_t compt = std::rand() % phy_dim;
+          o_matrix.SetSiteData(sample_idx, {row, col}, compt, ComptTensor(compt, true));
+        }
+      }
+    }
+    param_size = o_matrix.ParamSize();
+    const double total_num = double(sample_num * world.size());
+
+    std::vector<double> ave_flat;
+    o_matrix.TransMultiply(std::vector<double>(sample_num, 1.0 / total_num), ave_flat);
+    ::MPI_Allreduce(MPI_IN_PLACE, ave_flat.data(), param_size, MPI_DOUBLE, MPI_SUM, MPI_Comm(world));
+    gten_ave = o_matrix.Unflatten(ave_flat);
+
+    s_dense.assign(param_size * param_size, 0.0);
+    for (size_t l = 0; l < param_size; l++) {
+      std::vector<double> e(param_size, 0.0), col;
+      e[l] = 1.0;
+      o_matrix.MultiplyOOdag(e, col);
+      for (size_t k = 0; k < param_size; k++) {
+        s_dense[k * param_size + l] = col[k] / total_num;
+      }
+    }
+    ::MPI_Allreduce(MPI_IN_PLACE, s_dense.data(), s_dense.size(), MPI_DOUBLE, MPI_SUM, MPI_Comm(world));
+    for (size_t k = 0; k < param_size; k++) {
+      for (size_t l = 0; l < param_size; l++) {
+        s_dense[k * param_size + l] -= ave_flat[k] * ave_flat[l];
+      }
+      s_dense[k * param_size + k] += diag_shift;
+    }
+  }
+
+  std::vector<double> RandomFlatVector(void) {
+    std::srand(100);  // the same vector in all the processors
+    std::vector<double> r(param_size);
+    for (double &elem : r) {
+      elem = double(std::rand()) / RAND_MAX - 0.5;
+    }
+    return r;
+  }
+
+  std::vector<double> Apply(const SRPreconditioner<GQTEN_Double, U1QN> &precond, const std::vector<double> &r) {
+    std::vector<double> res;
+    o_matrix.Flatten(precond(o_matrix.Unflatten(r)), res);
+    return res;
+  }
+};
+
+TEST_F(TestSRPreconditioner, Jacobi) {
+  SRPreconditioner<GQTEN_Double, U1QN> precond(JacobiPreconditioner, &o_matrix, &gten_ave, diag_shift, world, true);
+  const std::vector<double> r = RandomFlatVector();
+  const std::vector<double> res = Apply(precond, r);
+  for (size_t k = 0; k < param_size; k++) {
+    EXPECT_NEAR(res[k], r[k] / s_dense[k * param_size + k], 1e-10 * std::abs(res[k]) + 1e-12);
+  }
+}
+
+TEST_F(TestSRPreconditioner, BlockJacobi) {
+  SRPreconditioner<GQTEN_Double, U1QN> precond(BlockJacobiPreconditioner, &o_matrix, &gten_ave, diag_shift, world,
+                                               true);
+  const std::vector<double> r = RandomFlatVector();
+  const std::vector<double> res = Apply(precond, r);
+  for (size_t site = 0; site < o_matrix.SiteNum(); site++) {
+    for (size_t compt = 0; compt < o_matrix.ComponentNum(site); compt++) {
+      const size_t n = o_matrix.ComponentSize(site, compt);
+      const size_t offset = o_matrix.ComponentOffset(site, compt);
+      std::vector<double> block(n * n), x(r.begin() + offset, r.begin() + offset + n);
+      for (size_t k = 0; k < n; k++) {
+        for (size_t l = 0; l < n; l++) {
+          block[k * n + l] = s_dense[(offset + k) * param_size + offset + l];
+        }
+      }
+      ASSERT_TRUE(CholeskySolve(block, x, n));
+      for (size_t k = 0; k < n; k++) {
+        EXPECT_NEAR(res[offset + k], x[k], 1e-8 * std::abs(x[k]) + 1e-10);
+      }
+    }
+  }
+}
+
+///< without all_reduce, the blocks are only reduced to and factorized in master
+TEST_F(TestSRPreconditioner, BlockJacobiInMaster) {
+  SRPreconditioner<GQTEN_Double, U1QN> precond_all(BlockJacobiPreconditioner, &o_matrix, &gten_ave, diag_shift, world,
+                                                   true);
+  SRPreconditioner<GQTEN_Double, U1QN> precond_master(BlockJacobiPreconditioner, &o_matrix, &gten_ave, diag_shift,
+                                                      world, false);
+  if (world.rank() == kMasterProc) {
+    const std::vector<double> r = RandomFlatVector();
+    const std::vector<double> res_all = Apply(precond_all, r), res_master = Apply(precond_master, r);
+    for (size_t k = 0; k < param_size; k++) {
+      EXPECT_DOUBLE_EQ(res_master[k], res_all[k]);
+    }
+  }
+}
+
+///< blocks larger than the max block size fall back to Jacobi
+TEST_F(TestSRPreconditioner, BlockJacobiSizeGuard) {
+  SRPreconditioner<GQTEN_Double, U1QN> precond(BlockJacobiPreconditioner, &o_matrix, &gten_ave, diag_shift, world,
+                                               true, 1);
+  const std::vector<double> r = RandomFlatVector();
+  const std::vector<double> res = Apply(precond, r);
+  for (size_t k = 0; k < param_size; k++) {
+    EXPECT_NEAR(res[k], r[k] / s_dense[k * param_size + k], 1e-10 * std::abs(res[k]) + 1e-12);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  boost::mpi::environment env;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
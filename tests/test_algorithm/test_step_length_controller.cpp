@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the step length controller.
+*/
+
+#include "gtest/gtest.h"
+#include "gqpeps/algorithm/vmc_update/step_length_controller.h"
+
+using namespace gqpeps;
+
+TEST(TestStepLengthController, GrowOnSuccessiveDecreases) {
+  StepLengthController controller(2.0, 0.5, 0.0, 0.3);
+  double step_len = 0.1;
+  EXPECT_FALSE(controller.Feed(-1.0, 0.01, 1.0, false, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.1);
+  EXPECT_FALSE(controller.Feed(-1.1, 0.01, 0.9, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.1);  // one decrease is not enough
+  EXPECT_FALSE(controller.Feed(-1.2, 0.01, 0.8, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.2);
+  EXPECT_FALSE(controller.Feed(-1.3, 0.01, 0.7, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.3);  // the upper limit
+  EXPECT_FALSE(controller.Feed(-1.4, 0.01, 0.75, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.3);
+}
+
+TEST(TestStepLengthController, RejectBeyondErrorBar) {
+  StepLengthController controller(2.0, 0.5, 0.01, 0.0, 2.0);
+  double step_len = 0.1;
+  controller.Feed(-1.0, 0.01, 1.0, false, step_len);
+  // within two error bars, kept
+  EXPECT_FALSE(controller.Feed(-0.98, 0.01, 1.0, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.1);
+  // beyond the error bars of the reference -0.98
+  EXPECT_TRUE(controller.Feed(-0.9, 0.01, 1.0, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.05);
+  // the energy of the restored TPS is compared with the same reference
+  EXPECT_TRUE(controller.Feed(-0.9, 0.01, 1.0, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.025);
+  EXPECT_TRUE(controller.Feed(-0.9, 0.01, 1.0, true, step_len));
+  EXPECT_TRUE(controller.Feed(-0.9, 0.01, 1.0, true, step_len));
+  EXPECT_DOUBLE_EQ(step_len, 0.01);  // the lower limit
+  // no update to reject
+  EXPECT_FALSE(controller.Feed(-0.5, 0.01, 1.0, false, step_len));
+}
+
+TEST(TestStepLengthController, DumpLoad) {
+  StepLengthController controller(2.0, 0.5, 0.0, 0.3);
+  double step_len = 0.1;
+  controller.Feed(-1.0 / 3.0, 0.01, 1.0, false, step_len);
+  controller.Feed(-0.4 - 1e-13, 0.01 / 3.0, 0.9, true, step_len);
+  const std::string filename = "test_step_length_controller_state";
+  controller.Dump(filename);
+
+  StepLengthController loaded(2.0, 0.5, 0.0, 0.3);
+  EXPECT_FALSE(loaded == controller);
+  ASSERT_TRUE(loaded.Load(filename));
+  EXPECT_TRUE(loaded == controller);
+  std::remove(filename.c_str());
+  EXPECT_FALSE(loaded.Load(filename));
+  EXPECT_TRUE(loaded == controller);
+}
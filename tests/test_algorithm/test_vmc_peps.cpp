@@ -17,6 +17,7 @@
 #include "gqpeps/algorithm/vmc_update/model_energy_solvers/spin_onehalf_squareJ1J2.h"           // SpinOneHalfJ1J2HeisenbergSquare
 #include "gqpeps/algorithm/vmc_update/model_energy_solvers/spin_onehalf_triangle_heisenberg_sqrpeps.h"
 #include "gqpeps/algorithm/vmc_update/model_energy_solvers/spin_onehalf_triangle_heisenbergJ1J2_sqrpeps.h"
+#include "gqpeps/algorithm/vmc_update/wave_function_component_classes/square_tps_sample_nn_flip_single_pass.h"
 
 #include "gqmps2/case_params_parser.h"
 
@@ -32,6 +33,7 @@ using DGQTensor = GQTensor<GQTEN_Double, U1QN>;
 using ZGQTensor = GQTensor<GQTEN_Complex, U1QN>;
 
 using TPSSampleNNFlipT = SquareTPSSampleNNFlip<GQTEN_Double, U1QN>;
+using TPSSampleNNFlipSinglePassT = SquareTPSSampleNNFlipSinglePass<GQTEN_Double, U1QN>;
 
 using gqmps2::CaseParamsParserBasic;
 
@@ -140,6 +142,151 @@ struct TestSpinSystemVMCPEPS : public testing::Test {
   }
 };
 
+///< exposes the checkpoint functions, the line search and the runtime data to the tests
+template<typename Model, typename WaveFunctionComponent>
+class VMCPEPSTestExecutor : public VMCPEPSExecutor<GQTEN_Double, U1QN, Model, WaveFunctionComponent> {
+  using Base = VMCPEPSExecutor<GQTEN_Double, U1QN, Model, WaveFunctionComponent>;
+ public:
+  using Base::Base;
+  using Base::WarmUp_;
+  using Base::DumpCheckpoint_;
+  using Base::LoadCheckpoint_;
+  using Base::LineSearch_;
+  using Base::ClearEnergyAndHoleSamples_;
+  using Base::SampleChains_;
+  using Base::GatherStatisticEnergyAndGrad_;
+  using Base::CalcNaturalGradient_;
+  using Base::KrylovSubspaceSRUpdate_;
+  using Base::grad_;
+  using Base::gten_sum_;
+  using Base::g_times_energy_sum_;
+  using Base::gten_samples_;
+  using Base::energy_samples_;
+  using Base::checkpoint_writer_;
+  using Base::start_iter_;
+  using Base::split_index_tps_;
+  using Base::natural_grad_;
+  using Base::chains_;
+  using Base::rand_stream_;
+  using Base::step_len_controller_;
+  using Base::tps_before_update_;
+  using Base::optimizer_before_update_;
+  using Base::energy_trajectory_;
+  using Base::energy_error_traj_;
+  using Base::grad_norm_;
+};
+
+/**
+ * Compare the local energy and the holes of the solver in the single orientation evaluation with the ones
+ * in the two passes, on the Neel configuration where every bond is evaluated by the exchanged amplitude.
+ * If the boundary MPS are not truncated (D_max = D^2), both evaluations are exact and agree up to the rounding.
+ * Otherwise they agree up to the truncation errors, in the relative tolerance tol.
+ */
+template<typename Model>
+void CheckSingleOrientationEvaluation(const SplitIndexTPS<GQTEN_Double, U1QN> &split_index_tps,
+                                      const size_t ly, const size_t lx, const size_t d, const size_t d_max,
+                                      const double tol, Model solver) {
+  TPSSampleNNFlipT::trun_para = BMPSTruncatePara(d, d_max, 1e-15, VARIATION2Site);
+  Configuration config(ly, lx);
+  for (size_t row = 0; row < ly; row++) {
+    for (size_t col = 0; col < lx; col++) {
+      config({row, col}) = (row + col) % 2;
+    }
+  }
+  TensorNetwork2D<GQTEN_Double, U1QN> holes_two_pass(ly, lx), holes_single(ly, lx);
+  TPSSampleNNFlipT tps_sample_two_pass(split_index_tps, config);
+  const GQTEN_Double energy_two_pass = solver.template CalEnergyAndHoles<TPSSampleNNFlipT, true>(
+      &split_index_tps, &tps_sample_two_pass, holes_two_pass);
+  solver.SetSingleOrientationEvaluation(true);
+  TPSSampleNNFlipT tps_sample_single(split_index_tps, config);
+  const GQTEN_Double energy_single = solver.template CalEnergyAndHoles<TPSSampleNNFlipT, true>(
+      &split_index_tps, &tps_sample_single, holes_single);
+
+  EXPECT_NEAR(energy_single, energy_two_pass, tol * std::abs(energy_two_pass));
+  for (size_t row = 0; row < ly; row++) {
+    for (size_t col = 0; col < lx; col++) {
+      DGQTensor diff = -holes_two_pass({row, col});
+      diff += holes_single({row, col});
+      EXPECT_NEAR(diff.Get2Norm(), 0.0, tol * holes_two_pass({row, col}).Get2Norm());
+    }
+  }
+}
+
+TEST_F(TestSpinSystemVMCPEPS, SingleOrientationEvaluation) {
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  const SplitIndexTPS<GQTEN_Double, U1QN> split_index_tps(tps);
+  const size_t d = params.D;
+  // untruncated, and truncated boundary MPS
+  for (const size_t d_max : {d * d, 2 * d}) {
+    const double tol = (d_max == d * d) ? 1e-10 : 1e-3;
+    CheckSingleOrientationEvaluation(split_index_tps, Ly, Lx, d, d_max, tol,
+                                     SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>());
+    CheckSingleOrientationEvaluation(split_index_tps, Ly, Lx, d, d_max, tol,
+                                     SpinOneHalfJ1J2HeisenbergSquare<GQTEN_Double, U1QN>(0.2));
+    CheckSingleOrientationEvaluation(split_index_tps, Ly, Lx, d, d_max, tol,
+                                     SpinOneHalfTriHeisenbergSqrPEPS<GQTEN_Double, U1QN>());
+  }
+  // not supported, always evaluated in two passes
+  CheckSingleOrientationEvaluation(split_index_tps, Ly, Lx, d, d * d, 1e-10,
+                                   SpinOneHalfTriJ1J2HeisenbergSqrPEPS<GQTEN_Double, U1QN>(0.2));
+}
+
+/**
+ * The Monte Carlo sweep and the solver reuse the boundary MPS which the other leaves behind. After each sweep,
+ * the amplitude, the local energy and the holes evaluated in the reused environments are compared with the ones of
+ * a fresh sample of the same configuration, whose boundary MPS are all generated by the solver.
+ */
+template<typename Model>
+void CheckReusedEnvironments(const SplitIndexTPS<GQTEN_Double, U1QN> &split_index_tps,
+                             const Configuration &init_config, const BMPSTruncatePara &trun_para, Model solver) {
+  const size_t ly = init_config.rows(), lx = init_config.cols();
+  TPSSampleNNFlipT::trun_para = trun_para;
+  TPSSampleNNFlipT tps_sample(split_index_tps, init_config);
+  RandomStream rand_stream(1, 0, 0);
+  std::vector<double> accept_rates;
+  for (size_t sweep = 0; sweep < 2; sweep++) {
+    tps_sample.MonteCarloSweepUpdate(split_index_tps, rand_stream, accept_rates);
+    TensorNetwork2D<GQTEN_Double, U1QN> holes(ly, lx), holes_fresh(ly, lx);
+    const GQTEN_Double energy = solver.template CalEnergyAndHoles<TPSSampleNNFlipT, true>(
+        &split_index_tps, &tps_sample, holes);
+    TPSSampleNNFlipT tps_sample_fresh(split_index_tps, tps_sample.config);
+    const GQTEN_Double energy_fresh = solver.template CalEnergyAndHoles<TPSSampleNNFlipT, true>(
+        &split_index_tps, &tps_sample_fresh, holes_fresh);
+
+    EXPECT_NEAR(tps_sample.amplitude, tps_sample_fresh.amplitude, 1e-10 * std::abs(tps_sample_fresh.amplitude));
+    EXPECT_NEAR(energy, energy_fresh, 1e-10 * std::abs(energy_fresh));
+    for (size_t row = 0; row < ly; row++) {
+      for (size_t col = 0; col < lx; col++) {
+        DGQTensor diff = -holes_fresh({row, col});
+        diff += holes({row, col});
+        EXPECT_NEAR(diff.Get2Norm(), 0.0, 1e-10 * holes_fresh({row, col}).Get2Norm());
+      }
+    }
+  }
+}
+
+TEST_F(TestSpinSystemVMCPEPS, ReusedEnvironments) {
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  const SplitIndexTPS<GQTEN_Double, U1QN> split_index_tps(tps);
+  const BMPSTruncatePara trun_para = optimize_para.bmps_trunc_para;
+  CheckReusedEnvironments(split_index_tps, optimize_para.init_config, trun_para,
+                          SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>());
+  CheckReusedEnvironments(split_index_tps, optimize_para.init_config, trun_para,
+                          SpinOneHalfJ1J2HeisenbergSquare<GQTEN_Double, U1QN>(0.2));
+  CheckReusedEnvironments(split_index_tps, optimize_para.init_config, trun_para,
+                          SpinOneHalfTriHeisenbergSqrPEPS<GQTEN_Double, U1QN>());
+  CheckReusedEnvironments(split_index_tps, optimize_para.init_config, trun_para,
+                          SpinOneHalfTriJ1J2HeisenbergSqrPEPS<GQTEN_Double, U1QN>(0.2));
+}
+
 TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4StochasticGradient) {
   using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
   VMCPEPSExecutor<GQTEN_Double, U1QN, Model, TPSSampleNNFlipT> *executor(nullptr);
@@ -185,6 +332,70 @@ TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4BMPSSingleSiteVariational) {
   delete executor;
 }
 
+///< the mean of the energy samples in all the processors and its error bar, estimated by the means of the bins
+template<typename ExecutorT>
+std::pair<double, double> BinnedEnergyAndError(const ExecutorT &executor, const boost::mpi::communicator &world,
+                                              const size_t bin_size) {
+  const std::vector<GQTEN_Double> &samples = executor.energy_samples_;
+  const size_t bin_num = samples.size() / bin_size;
+  double sums[3] = {double(bin_num), 0.0, 0.0}; // bin number, sum of the bin means and of their squares
+  for (size_t bin = 0; bin < bin_num; bin++) {
+    double bin_mean = 0.0;
+    for (size_t i = bin * bin_size; i < (bin + 1) * bin_size; i++) {
+      bin_mean += samples[i] / bin_size;
+    }
+    sums[1] += bin_mean;
+    sums[2] += bin_mean * bin_mean;
+  }
+  ::MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_DOUBLE, MPI_SUM, MPI_Comm(world));
+  const double mean = sums[1] / sums[0];
+  const double variance = (sums[2] / sums[0] - mean * mean) * sums[0] / (sums[0] - 1);
+  return {mean, std::sqrt(variance / sums[0])};
+}
+
+/**
+ * The single pass sweep with the single orientation evaluation samples the same distribution as the two pass
+ * sweep: the energies of the same TPS agree within the error bars, and both the horizontal and the vertical
+ * bonds accept some of the flips.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4SinglePassSweep) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using SinglePassExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipSinglePassT>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  const size_t bin_size = 10;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  ASSERT_GE(optimize_para.mc_samples, 2 * bin_size);
+
+  Model solver;
+  solver.SetSingleOrientationEvaluation(true);
+  SinglePassExecutorT single_pass_executor(optimize_para, tps, world, solver);
+  single_pass_executor.WarmUp_();
+  single_pass_executor.ClearEnergyAndHoleSamples_();
+  const std::vector<double> accept_rates = single_pass_executor.SampleChains_(false);
+  ASSERT_EQ(accept_rates.size(), size_t(2)); // horizontal and vertical bonds
+  for (const double rate : accept_rates) {
+    EXPECT_GT(rate, 0.0);
+    EXPECT_LE(rate, 1.0);
+  }
+
+  ExecutorT executor(optimize_para, tps, world);
+  executor.WarmUp_();
+  executor.ClearEnergyAndHoleSamples_();
+  executor.SampleChains_(false);
+
+  const auto [energy_single_pass, error_single_pass] = BinnedEnergyAndError(single_pass_executor, world, bin_size);
+  const auto [energy, error] = BinnedEnergyAndError(executor, world, bin_size);
+  if (world.rank() == kMasterProc) {
+    std::cout << "E0 of the single pass sweep = " << energy_single_pass << " +- " << error_single_pass
+              << ", E0 of the two pass sweep = " << energy << " +- " << error << std::endl;
+  }
+  EXPECT_NEAR(energy_single_pass, energy, 4 * std::sqrt(error_single_pass * error_single_pass + error * error));
+}
+
 TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4StochasticReconfigration) {
   using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
   VMCPEPSExecutor<GQTEN_Double, U1QN, Model, TPSSampleNNFlipT> *executor(nullptr);
@@ -208,6 +419,289 @@ TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4StochasticReconfigration) {
   delete executor;
 }
 
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4CheckpointRoundTrip) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  optimize_para.update_scheme = StochasticReconfiguration;
+  optimize_para.adaptive_step_len = true;
+  optimize_para.adaptive_iteration_num = 4;
+  optimize_para.checkpoint_path = "test_vmc_checkpoint";
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  ExecutorT executor(optimize_para, tps, world);
+  executor.Execute();
+  // pretend the state is the one after the iteration 1 of a schedule shortened by the walltime,
+  // with an update which can still be rejected.
+  const size_t iter = 1;
+  executor.optimize_para.step_lens.resize(3);
+  executor.tps_before_update_ = 0.5 * executor.split_index_tps_;
+  executor.DumpCheckpoint_(iter);
+  executor.checkpoint_writer_.Flush();
+  world.barrier();
+
+  auto check_loaded = [&](ExecutorT &loaded) {
+    ASSERT_TRUE(loaded.LoadCheckpoint_());
+    EXPECT_EQ(loaded.start_iter_, iter + 1);
+    EXPECT_EQ((loaded.split_index_tps_ - executor.split_index_tps_).NormSquare(), 0.0);
+    ASSERT_EQ(loaded.chains_.size(), executor.chains_.size());
+    for (size_t c = 0; c < executor.chains_.size(); c++) {
+      EXPECT_TRUE(loaded.chains_[c].rand_stream == executor.chains_[c].rand_stream);
+      for (size_t row = 0; row < Ly; row++) {
+        for (size_t col = 0; col < Lx; col++) {
+          EXPECT_EQ(loaded.chains_[c].tps_sample.config({row, col}),
+                    executor.chains_[c].tps_sample.config({row, col}));
+        }
+      }
+    }
+    EXPECT_TRUE(loaded.rand_stream_ == executor.rand_stream_);
+    EXPECT_EQ(loaded.optimize_para.step_lens, executor.optimize_para.step_lens);
+    if (world.rank() == kMasterProc) {
+      EXPECT_EQ((loaded.natural_grad_ - executor.natural_grad_).NormSquare(), 0.0);
+      ASSERT_EQ(loaded.tps_before_update_.rows(), Ly);
+      EXPECT_EQ((loaded.tps_before_update_ - executor.tps_before_update_).NormSquare(), 0.0);
+      EXPECT_EQ(loaded.optimizer_before_update_.Empty(), executor.optimizer_before_update_.Empty());
+      EXPECT_TRUE(loaded.step_len_controller_ == executor.step_len_controller_);
+      EXPECT_EQ(loaded.energy_trajectory_, executor.energy_trajectory_);
+      EXPECT_EQ(loaded.energy_error_traj_, executor.energy_error_traj_);
+      EXPECT_EQ(loaded.grad_norm_, executor.grad_norm_);
+    }
+  };
+  {
+    ExecutorT loaded(optimize_para, tps, world);
+    check_loaded(loaded);
+  }
+
+  // the checkpoint left in the temporary path when the job is killed during the renaming
+  if (world.rank() == kMasterProc) {
+    std::filesystem::rename(optimize_para.checkpoint_path, optimize_para.checkpoint_path + ".tmp");
+  }
+  world.barrier();
+  {
+    ExecutorT loaded(optimize_para, tps, world);
+    check_loaded(loaded);
+  }
+  world.barrier();
+  if (world.rank() == kMasterProc) {
+    std::filesystem::remove_all(optimize_para.checkpoint_path + ".tmp");
+  }
+}
+
+/**
+ * The line search in groups should take the same stride as the serial one. The direction is random and the later
+ * strides are large enough to destroy the state, so only the first stride lowers the energy, which is compared with
+ * the initial energy set above any sampled one.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4LineSearchInGroups) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+  const std::vector<double> strides = {1e-4, 100.0, 100.0};
+  optimize_para.step_lens = strides;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  SITPST direction(tps);
+  std::srand(0); // the same direction in all the processors
+  for (size_t row = 0; row < Ly; row++) {
+    for (size_t col = 0; col < Lx; col++) {
+      for (auto &ten : direction({row, col})) {
+        ten.Random(ten.Div());
+      }
+    }
+  }
+
+  for (size_t group_num : {1, 2}) {
+    optimize_para.line_search_groups = group_num;
+    ExecutorT executor(optimize_para, tps, world);
+    SITPST tps_expected = executor.split_index_tps_ + (-strides[0]) * direction;
+    tps_expected.NormalizeAllSite();
+    if (world.rank() == kMasterProc) {
+      executor.energy_trajectory_ = {1e10};
+    }
+    executor.LineSearch_(direction, strides);
+    if (world.rank() == kMasterProc) {
+      EXPECT_NEAR((executor.split_index_tps_ - tps_expected).NormSquare(), 0.0, 1e-20)
+          << "line_search_groups = " << group_num;
+    }
+  }
+}
+
+/**
+ * The gradient sums accumulated in blocks with the holes rescaled in place equal the direct sums
+ * sum_i O^*(S_i) and sum_i E_loc(S_i) O^*(S_i) of the recorded samples.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4BlockedGradientSums) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  optimize_para.update_scheme = StochasticReconfiguration;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  ExecutorT executor(optimize_para, tps, world);
+  executor.ClearEnergyAndHoleSamples_();
+  executor.SampleChains_(true);
+
+  const auto &o_samples = executor.gten_samples_;
+  ASSERT_EQ(o_samples.SampleNum(), executor.energy_samples_.size());
+  const std::vector<GQTEN_Double> ones(o_samples.SampleNum(), 1.0);
+  std::vector<GQTEN_Double> gten_sum, g_times_energy_sum, gten_sum_blocked, g_times_energy_sum_blocked;
+  o_samples.TransMultiply(ones, gten_sum);
+  o_samples.TransMultiply(executor.energy_samples_, g_times_energy_sum);
+  o_samples.Flatten(executor.gten_sum_, gten_sum_blocked);
+  o_samples.Flatten(executor.g_times_energy_sum_, g_times_energy_sum_blocked);
+  double norm_sqr = 0.0, e_norm_sqr = 0.0;
+  for (size_t i = 0; i < gten_sum.size(); i++) {
+    norm_sqr += gten_sum[i] * gten_sum[i];
+    e_norm_sqr += g_times_energy_sum[i] * g_times_energy_sum[i];
+  }
+  for (size_t i = 0; i < gten_sum.size(); i++) {
+    EXPECT_NEAR(gten_sum_blocked[i], gten_sum[i], 1e-12 * std::sqrt(norm_sqr));
+    EXPECT_NEAR(g_times_energy_sum_blocked[i], g_times_energy_sum[i], 1e-12 * std::sqrt(e_norm_sqr));
+  }
+}
+
+/**
+ * Two chains in one processor give the same samples as the two chains sampled one after the other on the same
+ * random streams: the energy samples are merged in the order of the chains, the gradient sums are added up and
+ * the accept rates are averaged over all the samples.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4TwoChainsAgreeWithSequentialChains) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+  const size_t chain_sample_num = 10;
+  optimize_para.update_scheme = StochasticGradient;
+  optimize_para.random_seed = 20261017;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+
+  optimize_para.chains_per_proc = 2;
+  optimize_para.mc_samples = 2 * chain_sample_num;
+  ExecutorT executor_two_chains(optimize_para, tps, world);
+  ASSERT_EQ(executor_two_chains.chains_.size(), size_t(2));
+  executor_two_chains.ClearEnergyAndHoleSamples_();
+  const std::vector<double> accept_rates = executor_two_chains.SampleChains_(true);
+
+  optimize_para.chains_per_proc = 1;
+  optimize_para.mc_samples = chain_sample_num;
+  ExecutorT executor(optimize_para, tps, world);
+  const Configuration init_config = executor.chains_[0].tps_sample.config;
+  std::vector<GQTEN_Double> energy_samples;
+  std::vector<double> accept_rates_sum;
+  SITPST gten_sum, g_times_energy_sum;
+  for (size_t c = 0; c < 2; c++) {
+    executor.chains_[0].rand_stream.Seed(optimize_para.random_seed, world.rank(), c);
+    executor.chains_[0].tps_sample = TPSSampleNNFlipT(executor.split_index_tps_, init_config);
+    executor.ClearEnergyAndHoleSamples_();
+    const std::vector<double> chain_accept_rates = executor.SampleChains_(true);
+    energy_samples.insert(energy_samples.end(), executor.energy_samples_.cbegin(), executor.energy_samples_.cend());
+    accept_rates_sum.resize(chain_accept_rates.size(), 0.0);
+    for (size_t i = 0; i < chain_accept_rates.size(); i++) {
+      accept_rates_sum[i] += chain_accept_rates[i];
+    }
+    if (c == 0) {
+      gten_sum = executor.gten_sum_;
+      g_times_energy_sum = executor.g_times_energy_sum_;
+    } else {
+      gten_sum += executor.gten_sum_;
+      g_times_energy_sum += executor.g_times_energy_sum_;
+    }
+  }
+
+  ASSERT_EQ(executor_two_chains.energy_samples_.size(), energy_samples.size());
+  for (size_t i = 0; i < energy_samples.size(); i++) {
+    EXPECT_DOUBLE_EQ(executor_two_chains.energy_samples_[i], energy_samples[i]);
+  }
+  EXPECT_LT((executor_two_chains.gten_sum_ - gten_sum).NormSquare(), 1e-20 * gten_sum.NormSquare());
+  EXPECT_LT((executor_two_chains.g_times_energy_sum_ - g_times_energy_sum).NormSquare(),
+            1e-20 * g_times_energy_sum.NormSquare());
+  ASSERT_EQ(accept_rates.size(), accept_rates_sum.size());
+  for (size_t i = 0; i < accept_rates.size(); i++) {
+    EXPECT_NEAR(accept_rates[i], accept_rates_sum[i] / 2, 1e-14);
+  }
+}
+
+/**
+ * For a large shift, the Krylov subspace SR with the subspace {g, S g, ..., S^(n-1) g} gives the stochastic
+ * reconfiguration step of length 1 / shift in the subspace, which is the result of n conjugate gradient iterations
+ * from zero on the same samples.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4KrylovSubspaceSRAgreesWithSR) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+  const size_t krylov_dim = 3;
+  const double shift = 1e6;
+  optimize_para.update_scheme = StochasticReconfiguration;
+  optimize_para.grad_all_reduce = true;
+  optimize_para.krylov_sr_dim = krylov_dim;
+  optimize_para.krylov_sr_shift = shift;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  ExecutorT executor(optimize_para, tps, world);
+  executor.cg_params = ConjugateGradientParams(krylov_dim, 0.0, 100, 0.0);
+  executor.ClearEnergyAndHoleSamples_();
+  executor.SampleChains_(true);
+  executor.GatherStatisticEnergyAndGrad_();
+  executor.CalcNaturalGradient_(executor.grad_, SITPST(Ly, Lx, executor.split_index_tps_.PhysicalDim()));
+
+  SITPST update;
+  double predicted_energy;
+  ASSERT_TRUE(executor.KrylovSubspaceSRUpdate_(update, predicted_energy));
+  if (world.rank() == kMasterProc) {
+    const SITPST &natural_grad = executor.natural_grad_;
+    const double diff = (shift * update + natural_grad).NormSquare();
+    EXPECT_LT(diff, 1e-6 * natural_grad.NormSquare());
+  }
+}
+
+/**
+ * With fewer samples than the variational parameters, the natural gradient of the sample space SR (minSR) equals
+ * (S + shift)^(-1) g solved by the conjugate gradient on the same samples.
+ */
+TEST_F(TestSpinSystemVMCPEPS, SquareHeisenbergD4SampleSpaceSRAgreesWithCG) {
+  using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
+  using ExecutorT = VMCPEPSTestExecutor<Model, TPSSampleNNFlipT>;
+  using SITPST = SplitIndexTPS<GQTEN_Double, U1QN>;
+  optimize_para.update_scheme = StochasticReconfiguration;
+  optimize_para.mc_samples = 20;
+  optimize_para.grad_all_reduce = true;
+  TPS<GQTEN_Double, U1QN> tps = TPS<GQTEN_Double, U1QN>(Ly, Lx);
+  if (!tps.Load("tps_heisenberg_D" + std::to_string(params.D))) {
+    std::cout << "Loading simple updated TPS files is broken." << std::endl;
+    exit(-2);
+  };
+  ExecutorT executor(optimize_para, tps, world);
+  executor.cg_params = ConjugateGradientParams(1000, 1e-14, 20, 1e-2);
+  executor.ClearEnergyAndHoleSamples_();
+  executor.SampleChains_(true);
+  executor.GatherStatisticEnergyAndGrad_();
+  ASSERT_LT(executor.gten_samples_.SampleNum() * world.size(), executor.gten_samples_.ParamSize());
+
+  const SITPST init_guess(Ly, Lx, executor.split_index_tps_.PhysicalDim());
+  executor.CalcNaturalGradient_(executor.grad_, init_guess);
+  const SITPST cg_natural_grad = executor.natural_grad_;
+  executor.optimize_para.update_scheme = SampleSpaceStochasticReconfiguration;
+  EXPECT_EQ(executor.CalcNaturalGradient_(executor.grad_, init_guess), size_t(1));
+  if (world.rank() == kMasterProc) {
+    const double diff = (executor.natural_grad_ - cg_natural_grad).NormSquare();
+    EXPECT_LT(diff, 1e-8 * cg_natural_grad.NormSquare());
+  }
+}
+
 TEST_F(TestSpinSystemVMCPEPS, HeisenbergD4GradientLineSearch) {
   using Model = SpinOneHalfHeisenbergSquare<GQTEN_Double, U1QN>;
   VMCPEPSExecutor<GQTEN_Double, U1QN, Model, TPSSampleNNFlipT> *executor(nullptr);
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the counter-based random number streams.
+*/
+
+#include <filesystem>
+#include "gtest/gtest.h"
+#include "gqpeps/monte_carlo_tools/random_stream.h"
+
+using namespace gqpeps;
+
+// known answers from the Random123 library
+TEST(RandomStreamTest, Philox4x32_10KnownAnswer) {
+  using Block = std::array<uint32_t, 4>;
+  using Key = std::array<uint32_t, 2>;
+  EXPECT_EQ(RandomStream::Philox4x32_10(Block{0, 0, 0, 0}, Key{0, 0}),
+            (Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+  EXPECT_EQ(RandomStream::Philox4x32_10(Block{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                        Key{0xffffffff, 0xffffffff}),
+            (Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+  EXPECT_EQ(RandomStream::Philox4x32_10(Block{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                                        Key{0xa4093822, 0x299f31d0}),
+            (Block{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(RandomStreamTest, Reproducible) {
+  RandomStream a(2024, 1, 3), b(2024, 1, 3);
+  for (size_t i = 0; i < 1000; i++) {
+    EXPECT_EQ(a(), b());
+  }
+  b.Seed(2024, 1, 3);
+  RandomStream c(2024, 1, 3);
+  EXPECT_EQ(b, c);
+}
+
+TEST(RandomStreamTest, IndependentStreams) {
+  const size_t n = 100000;
+  RandomStream a(7, 0, 0), b(7, 0, 1), c(7, 1, 0);
+  double mean_a = 0, mean_b = 0, corr_ab = 0, corr_ac = 0;
+  size_t same = 0;
+  for (size_t i = 0; i < n; i++) {
+    double xa = a.Uniform(), xb = b.Uniform(), xc = c.Uniform();
+    EXPECT_GE(xa, 0.0);
+    EXPECT_LT(xa, 1.0);
+    mean_a += xa;
+    mean_b += xb;
+    corr_ab += (xa - 0.5) * (xb - 0.5);
+    corr_ac += (xa - 0.5) * (xc - 0.5);
+    same += (xa == xb) + (xa == xc);
+  }
+  EXPECT_EQ(same, 0u);
+  // 5 sigma bounds, sigma(mean) = 1/sqrt(12 n), sigma(corr) = 1/(12 sqrt(n))
+  EXPECT_NEAR(mean_a / n, 0.5, 5.0 / std::sqrt(12.0 * n));
+  EXPECT_NEAR(mean_b / n, 0.5, 5.0 / std::sqrt(12.0 * n));
+  EXPECT_NEAR(corr_ab / n, 0.0, 5.0 / (12.0 * std::sqrt(n)));
+  EXPECT_NEAR(corr_ac / n, 0.0, 5.0 / (12.0 * std::sqrt(n)));
+}
+
+TEST(RandomStreamTest, DumpAndLoadContinueTheStream) {
+  const std::string path = "random_stream_test";
+  for (size_t consumed : {0, 1, 3, 4, 9}) {
+    RandomStream a(99, 2, 5);
+    for (size_t i = 0; i < consumed; i++) {
+      a();
+    }
+    a.Dump(path, consumed);
+    RandomStream b;
+    ASSERT_TRUE(b.Load(path, consumed));
+    EXPECT_EQ(a, b);
+    for (size_t i = 0; i < 20; i++) {
+      EXPECT_EQ(a(), b());
+    }
+  }
+  RandomStream d;
+  EXPECT_FALSE(d.Load(path, 1000));
+  std::filesystem::remove_all(path);
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the reweighted (correlated sampling) energy estimate
+* on synthetic weights and energies.
+*/
+
+#include <random>
+#include "gtest/gtest.h"
+#include "gqpeps/monte_carlo_tools/reweighting.h"
+
+using namespace gqpeps;
+
+class ReweightingTest : public ::testing::Test {
+ protected:
+  boost::mpi::communicator world;
+  const double min_ess_ratio = 0.5;   // the default reweighting_min_ess_ratio
+  void SetUp() override {
+    ::testing::TestEventListeners &listeners =
+        ::testing::UnitTest::GetInstance()->listeners();
+    if (world.rank() != 0) {
+      delete listeners.Release(listeners.default_result_printer());
+    }
+  }
+};
+
+TEST_F(ReweightingTest, ExactValues) {
+  const std::vector<double> ws = {1.0, 2.0, 3.0};
+  const std::vector<double> es = {-1.0, -2.0, -4.0};
+  ReweightingSums<double> sums;
+  for (size_t i = 0; i < ws.size(); i++) {
+    sums.Add(ws[i], es[i]);
+  }
+  double energy, err, ess_ratio;
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  // (-1 - 4 - 12) / 6
+  EXPECT_DOUBLE_EQ(energy, -17.0 / 6.0);
+  // sum w^2 (E - <E>)^2 / (sum w)^2
+  double err_sqr = 0.0;
+  for (size_t i = 0; i < ws.size(); i++) {
+    err_sqr += ws[i] * ws[i] * (es[i] - energy) * (es[i] - energy);
+  }
+  EXPECT_NEAR(err, std::sqrt(err_sqr) / 6.0, 1e-14);
+  EXPECT_DOUBLE_EQ(ess_ratio, 36.0 / (14.0 * 3.0));
+}
+
+TEST_F(ReweightingTest, ComplexEnergy) {
+  ReweightingSums<std::complex<double>> sums;
+  sums.Add(1.0, std::complex<double>(1.0, 1.0));
+  sums.Add(1.0, std::complex<double>(-1.0, -1.0));
+  std::complex<double> energy;
+  double err, ess_ratio;
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  EXPECT_NEAR(std::abs(energy), 0.0, 1e-15);
+  // sqrt(2 + 2) / 2
+  EXPECT_NEAR(err, 1.0, 1e-14);
+  EXPECT_DOUBLE_EQ(ess_ratio, 1.0);
+}
+
+///< the unchanged wave function gives the plain average with the full effective sample size
+TEST_F(ReweightingTest, EqualWeights) {
+  std::mt19937 engine(5);
+  std::normal_distribution<double> normal(-0.5, 0.1);
+  ReweightingSums<double> sums;
+  double e_sum = 0.0;
+  const size_t n = 100;
+  for (size_t i = 0; i < n; i++) {
+    const double e = normal(engine);
+    e_sum += e;
+    sums.Add(1.0, e);
+  }
+  double energy, err, ess_ratio;
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  EXPECT_NEAR(energy, e_sum / n, 1e-14);
+  EXPECT_NEAR(ess_ratio, 1.0, 1e-14);
+  EXPECT_GE(ess_ratio, min_ess_ratio);
+}
+
+///< a dominant weight collapses the effective sample size, which sends the line search back to the fresh sampling
+TEST_F(ReweightingTest, ESSCollapse) {
+  ReweightingSums<double> sums;
+  const size_t n = 100;
+  for (size_t i = 0; i < n - 1; i++) {
+    sums.Add(1e-3, -1.0);
+  }
+  sums.Add(10.0, -2.0);
+  double energy, err, ess_ratio;
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  EXPECT_NEAR(energy, -2.0, 0.01);
+  const double w_sum = 10.0 + 99 * 1e-3, w2_sum = 100.0 + 99 * 1e-6;
+  EXPECT_NEAR(ess_ratio, w_sum * w_sum / (w2_sum * n), 1e-14);
+  EXPECT_LT(ess_ratio, min_ess_ratio);
+}
+
+///< all the weights vanish: no estimate, rejected by any threshold
+TEST_F(ReweightingTest, ZeroWeights) {
+  ReweightingSums<double> sums;
+  double energy, err, ess_ratio;
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  EXPECT_EQ(energy, 0.0);
+  EXPECT_TRUE(std::isinf(err));
+  EXPECT_EQ(ess_ratio, 0.0);
+
+  for (size_t i = 0; i < 10; i++) {
+    sums.Add(0.0, -1.0);
+  }
+  std::tie(energy, err, ess_ratio) = sums.Estimate();
+  EXPECT_EQ(energy, 0.0);
+  EXPECT_TRUE(std::isinf(err));
+  EXPECT_EQ(ess_ratio, 0.0);
+  EXPECT_LT(ess_ratio, min_ess_ratio);
+}
+
+///< the sums distributed over the processors give the same estimate as the serial sums
+TEST_F(ReweightingTest, AllReduce) {
+  const size_t n_per_proc = 50;
+  std::mt19937 engine(11);
+  std::uniform_real_distribution<double> uniform(0.1, 2.0);
+  std::normal_distribution<double> normal(-0.5, 0.1);
+  ReweightingSums<std::complex<double>> local_sums, serial_sums;
+  for (size_t proc = 0; proc < size_t(world.size()); proc++) {
+    for (size_t i = 0; i < n_per_proc; i++) {
+      const double w = uniform(engine);
+      const std::complex<double> e(normal(engine), 0.1 * normal(engine));
+      serial_sums.Add(w, e);
+      if (proc == size_t(world.rank())) {
+        local_sums.Add(w, e);
+      }
+    }
+  }
+  local_sums.AllReduce(world);
+  EXPECT_EQ(local_sums.sample_num, serial_sums.sample_num);
+  std::complex<double> energy, serial_energy;
+  double err, ess_ratio, serial_err, serial_ess_ratio;
+  std::tie(energy, err, ess_ratio) = local_sums.Estimate();
+  std::tie(serial_energy, serial_err, serial_ess_ratio) = serial_sums.Estimate();
+  EXPECT_NEAR(std::abs(energy - serial_energy), 0.0, 1e-12);
+  EXPECT_NEAR(err, serial_err, 1e-12);
+  EXPECT_NEAR(ess_ratio, serial_ess_ratio, 1e-12);
+}
+
+int main(int argc, char *argv[]) {
+  boost::mpi::environment env;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
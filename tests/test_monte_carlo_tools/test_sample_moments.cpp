@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the error estimates and the stopping decision
+* of the adaptive sampling.
+*/
+
+#include <random>
+#include "gtest/gtest.h"
+#include "boost/serialization/vector.hpp"
+#include "gqpeps/monte_carlo_tools/sample_moments.h"
+
+using namespace gqpeps;
+
+class SampleMomentsTest : public ::testing::Test {
+ protected:
+  boost::mpi::communicator world;
+  void SetUp() override {
+    ::testing::TestEventListeners &listeners =
+        ::testing::UnitTest::GetInstance()->listeners();
+    if (world.rank() != 0) {
+      delete listeners.Release(listeners.default_result_printer());
+    }
+  }
+};
+
+TEST_F(SampleMomentsTest, EnergyError) {
+  SampleMoments moments;
+  for (double energy : {1.0, 2.0, 3.0, 4.0, 5.0}) {
+    moments.Add(energy, 1.0);
+  }
+  EXPECT_DOUBLE_EQ(moments.EnergyMean().real(), 3.0);
+  EXPECT_DOUBLE_EQ(moments.EnergyMean().imag(), 0.0);
+  EXPECT_NEAR(moments.EnergyError(), std::sqrt(2.0 / 5.0), 1e-14);
+
+  SampleMoments complex_moments;
+  complex_moments.Add(std::complex<double>(1.0, 1.0), 0.0);
+  complex_moments.Add(std::complex<double>(-1.0, -1.0), 0.0);
+  // |E - <E>|^2 = 2 for both samples
+  EXPECT_NEAR(complex_moments.EnergyError(), 1.0, 1e-14);
+}
+
+TEST_F(SampleMomentsTest, GradientError) {
+  std::mt19937 engine(3);
+  std::normal_distribution<double> normal(-0.5, 0.2);
+  std::uniform_real_distribution<double> uniform(0.5, 2.0);
+  std::vector<std::complex<double>> energies;
+  std::vector<double> o_norm_sqrs;
+  SampleMoments moments;
+  for (size_t i = 0; i < 1000; i++) {
+    energies.emplace_back(normal(engine), 0.1 * normal(engine));
+    o_norm_sqrs.push_back(uniform(engine));
+    moments.Add(energies.back(), o_norm_sqrs.back());
+  }
+  std::complex<double> e_ave(0.0);
+  for (const auto &energy : energies) {
+    e_ave += energy;
+  }
+  e_ave /= double(energies.size());
+  double x_norm_sqr = 0.0;
+  for (size_t i = 0; i < energies.size(); i++) {
+    x_norm_sqr += std::norm(energies[i] - e_ave) * o_norm_sqrs[i];
+  }
+  x_norm_sqr /= double(energies.size());
+  const double grad_norm_sqr = 0.01;
+  EXPECT_NEAR(moments.GradientError(grad_norm_sqr), std::sqrt((x_norm_sqr - grad_norm_sqr) / 1000.0), 1e-12);
+  // the negative variance by the round-off is cut
+  EXPECT_EQ(moments.GradientError(1e10), 0.0);
+}
+
+TEST_F(SampleMomentsTest, StoppingDecision) {
+  SampleMoments moments;
+  for (double energy : {-1.0, -1.1, -0.9, -1.0}) {
+    moments.Add(energy, 1.0);
+  }
+  const double energy_rel_err = moments.EnergyError() / 1.0;
+  EXPECT_TRUE(SamplingConverged(moments, 1.01 * energy_rel_err, 0.0, 0.0, true));
+  EXPECT_FALSE(SamplingConverged(moments, 0.99 * energy_rel_err, 0.0, 0.0, true));
+  // no target applies
+  EXPECT_FALSE(SamplingConverged(moments, 0.0, 0.0, 1.0, true));
+  EXPECT_FALSE(SamplingConverged(moments, 0.0, 1.0, 1.0, false));
+  // the gradient target is never reached without the gradient norm of the last iteration
+  EXPECT_FALSE(SamplingConverged(moments, 0.0, 1e10, 0.0, true));
+  const double grad_norm_sqr = 1e-4;
+  const double grad_rel_err = moments.GradientError(grad_norm_sqr) / std::sqrt(grad_norm_sqr);
+  EXPECT_TRUE(SamplingConverged(moments, 0.0, 1.01 * grad_rel_err, grad_norm_sqr, true));
+  EXPECT_FALSE(SamplingConverged(moments, 0.0, 0.99 * grad_rel_err, grad_norm_sqr, true));
+  // both targets should be reached
+  EXPECT_FALSE(SamplingConverged(moments, 1.01 * energy_rel_err, 0.99 * grad_rel_err, grad_norm_sqr, true));
+  // the gradient target is ignored in the energy only samplings
+  EXPECT_TRUE(SamplingConverged(moments, 1.01 * energy_rel_err, 0.99 * grad_rel_err, grad_norm_sqr, false));
+}
+
+///< the processors draw the different samples in blocks, and should stop at the same block as the serial decision
+///< on all the samples.
+TEST_F(SampleMomentsTest, CollectiveStopAtTheSameBlock) {
+  const size_t block_size = 10, max_block_num = 1000;
+  const double energy_target = 2e-3;
+  std::mt19937 engine(world.rank() + 7);
+  // a broad distribution in the other processors, so the local decisions would differ
+  std::normal_distribution<double> normal(-1.0, world.rank() == 0 ? 0.05 : 0.3);
+  SampleMoments local_moments;
+  std::vector<double> local_energies;
+  size_t stop_block = max_block_num;
+  for (size_t block = 0; block < max_block_num; block++) {
+    for (size_t i = 0; i < block_size; i++) {
+      local_energies.push_back(normal(engine));
+      local_moments.Add(local_energies.back(), 0.0);
+    }
+    if (SamplingConverged(local_moments, energy_target, 0.0, 0.0, false, world)) {
+      stop_block = block;
+      break;
+    }
+  }
+  ASSERT_LT(stop_block, max_block_num);
+  std::vector<size_t> stop_blocks;
+  boost::mpi::all_gather(world, stop_block, stop_blocks);
+  for (size_t proc_stop_block : stop_blocks) {
+    EXPECT_EQ(proc_stop_block, stop_block);
+  }
+
+  // the serial decisions on the gathered samples
+  std::vector<std::vector<double>> all_energies;
+  boost::mpi::gather(world, local_energies, all_energies, kMasterProc);
+  if (world.rank() == kMasterProc) {
+    for (size_t block = 0; block <= stop_block; block++) {
+      SampleMoments moments;
+      for (const auto &energies : all_energies) {
+        for (size_t i = 0; i < (block + 1) * block_size; i++) {
+          moments.Add(energies[i], 0.0);
+        }
+      }
+      EXPECT_EQ(SamplingConverged(moments, energy_target, 0.0, 0.0, false), block == stop_block);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  boost::mpi::environment env;
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -40,3 +40,18 @@ TEST_F(StatisticsTest, AveListOfDataTest) {
   std::vector<double> actualAve = gqpeps::AveListOfData(data);
   EXPECT_EQ(expectedAve, actualAve);
 }
+
+TEST_F(StatisticsTest, DumpLoadVecDataExactly) {
+  std::vector<double> data = {1.0 / 3.0, -2.0 / 7.0 * 1e-12, 123456.789012345678, 0.1 + 0.2};
+  std::vector<std::complex<double>> complex_data = {{1.0 / 3.0, -1.0 / 7.0}, {1e-300, 2.0 / 3.0 * 1e10}};
+  const std::string filename = "test_statistics_vec_data";
+  gqpeps::DumpVecData(filename, data);
+  std::vector<double> loaded;
+  ASSERT_TRUE(gqpeps::LoadVecData(filename, loaded));
+  EXPECT_EQ(data, loaded);
+  gqpeps::DumpVecData(filename, complex_data);
+  std::vector<std::complex<double>> complex_loaded;
+  ASSERT_TRUE(gqpeps::LoadVecData(filename, complex_loaded));
+  EXPECT_EQ(complex_data, complex_loaded);
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the background writer thread.
+*/
+
+#include <vector>
+#include <chrono>
+#include "gqpeps/utility/background_writer.h"
+#include "gtest/gtest.h"
+
+using namespace gqpeps;
+
+TEST(TestBackgroundWriter, TasksRunInOrderBeforeFlush) {
+  std::vector<int> record;
+  BackgroundWriter writer;
+  for (int i = 0; i < 100; i++) {
+    writer.Submit([&record, i] {
+      if (i % 10 == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      record.push_back(i);
+    });
+  }
+  writer.Flush();
+  ASSERT_EQ(record.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(record[i], i);
+  }
+}
+
+TEST(TestBackgroundWriter, SnapshotIsIndependentOfTheData) {
+  std::vector<double> data = {1.0, 2.0, 3.0};
+  std::vector<double> written;
+  {
+    BackgroundWriter writer;
+    writer.Submit([snapshot = data, &written] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      written = snapshot;
+    });
+    data[0] = -1.0; // the computation goes on
+  } // the destructor flushes
+  EXPECT_EQ(written, std::vector<double>({1.0, 2.0, 3.0}));
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for dense Cholesky solver
+*/
+
+#include "gqpeps/utility/cholesky_solver.h"
+#include "gtest/gtest.h"
+
+using namespace gqpeps;
+
+TEST(TestCholeskySolver, RealMatrix) {
+  std::vector<double> a = {1.0, 2.0, 3.0,
+                           2.0, 5.0, 7.0,
+                           3.0, 7.0, 15.0};
+  std::vector<double> b = {11.0, 12.0, 13.0};
+  std::vector<double> x_res = {33.0, -8.0, -2.0};
+  EXPECT_TRUE(CholeskySolve(a, b, 3));
+  for (size_t i = 0; i < 3; i++) {
+    EXPECT_NEAR(b[i], x_res[i], 1e-12);
+  }
+}
+
+TEST(TestCholeskySolver, ComplexMatrix) {
+  using Complex = std::complex<double>;
+  std::vector<Complex> a = {Complex(4.0, 0.0), Complex(1.0, 1.0),
+                            Complex(1.0, -1.0), Complex(3.0, 0.0)};
+  std::vector<Complex> b = {Complex(3.0, 1.0), Complex(1.0, 2.0)};
+  std::vector<Complex> x_res = {Complex(1.0, 0.0), Complex(0.0, 1.0)};
+  EXPECT_TRUE(CholeskySolve(a, b, 2));
+  for (size_t i = 0; i < 2; i++) {
+    EXPECT_NEAR(std::abs(b[i] - x_res[i]), 0.0, 1e-12);
+  }
+}
+
+TEST(TestCholeskySolver, NotPositiveDefinite) {
+  std::vector<double> a = {1.0, 2.0,
+                           2.0, 1.0};
+  std::vector<double> b = {1.0, 1.0};
+  EXPECT_FALSE(CholeskySolve(a, b, 2));
+}
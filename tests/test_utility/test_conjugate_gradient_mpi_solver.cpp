@@ -45,6 +45,16 @@ size_t CGSolverRecvVector(
   boost::mpi::status status = world.recv(src, tag, v.GetElements());
   return status.source();
 }
+
+template<typename ElemT>
+void CGSolverAllReduceVector(
+    MyVector<ElemT> &v,
+    const boost::mpi::communicator &world
+) {
+  std::vector<ElemT> res(v.GetSize());
+  boost::mpi::all_reduce(world, v.GetElements().data(), v.GetSize(), res.data(), std::plus<ElemT>());
+  v.GetElements() = res;
+}
 }
 
 #include "gqpeps/utility/conjugate_gradient_solver.h"
@@ -68,6 +78,52 @@ void RunTestPlainCGSolverParallelCase(
   }
 }
 
+template<typename ElemT>
+void RunTestAllReduceCGSolverParallelCase(
+    const MySquareMatrix<ElemT> &mat,
+    const MyVector<ElemT> &b,
+    const MyVector<ElemT> &x0,
+    const MyVector<ElemT> x_res,
+    communicator &world
+) {
+  size_t iter;
+  auto x = ConjugateGradientSolverAllReduce(mat, b, x0, 100, 1e-16, 20, iter, world);
+  auto diff_vec = x - x_res;
+  EXPECT_NEAR(diff_vec.NormSquare(), 0.0, 1e-13);
+}
+
+MySquareMatrix<double> DistributedTestMatrix(const communicator &world) {
+  MySquareMatrix<double> dmat;
+  if (world.rank() == 0) {
+    dmat = MySquareMatrix<double>({{0.0, 2.0, 2.0},
+                                   {2.0, 0.0, 7.0},
+                                   {2.0, 7.0, 8.0}});
+  } else if (world.rank() == 1) {
+    dmat = MySquareMatrix<double>({{1.0, 0.0, 0.0},
+                                   {0.0, 5.0, 0.0},
+                                   {0.0, 0.0, 7.0}});
+  } else if (world.rank() == 2) {
+    dmat = MySquareMatrix<double>({{0.0, 0.0, 1.0},
+                                   {0.0, 0.0, 0.0},
+                                   {1.0, 0.0, 0.0}});
+  }
+  return dmat;
+}
+
+///< M^(-1) = diag(A)^(-1)
+template<typename ElemT>
+struct MyJacobiPreconditioner {
+  std::vector<ElemT> diag;
+
+  MyVector<ElemT> operator()(const MyVector<ElemT> &r) const {
+    std::vector<ElemT> z = r.GetElements();
+    for (size_t i = 0; i < z.size(); i++) {
+      z[i] /= diag[i];
+    }
+    return MyVector<ElemT>(z);
+  }
+};
+
 TEST(TestPlainCGSolver, Parallel) {
   boost::mpi::communicator world;
   ::testing::TestEventListeners &listeners =
@@ -107,6 +163,35 @@ TEST(TestPlainCGSolver, Parallel) {
 //  RunTestPlainCGSolverParallelCase(zmat1, zb1, zx01, zx_res1, world);
 }
 
+TEST(TestAllReduceCGSolver, Parallel) {
+  boost::mpi::communicator world;
+  MySquareMatrix<double> dmat1 = DistributedTestMatrix(world);
+  MyVector<double> db1({11.0,
+                        12.0,
+                        13.0});
+  MyVector<double> dx01({-1.0, 1.0, 0.0});
+  MyVector<double> dx_res1({33.0, -8.0, -2.0});
+  RunTestAllReduceCGSolverParallelCase(dmat1, db1, dx01, dx_res1, world);
+}
+
+TEST(TestPreconditionedCGSolver, Parallel) {
+  boost::mpi::communicator world;
+  MySquareMatrix<double> dmat1 = DistributedTestMatrix(world);
+  MyVector<double> db1({11.0,
+                        12.0,
+                        13.0});
+  MyVector<double> dx01({-1.0, 1.0, 0.0});
+  MyVector<double> dx_res1({33.0, -8.0, -2.0});
+  MyJacobiPreconditioner<double> precond{{1.0, 5.0, 15.0}};
+  size_t iter;
+  auto x = ConjugateGradientSolver(dmat1, db1, dx01, 100, 1e-16, 20, iter, world, precond);
+  if (world.rank() == kMasterProc) {
+    EXPECT_NEAR((x - dx_res1).NormSquare(), 0.0, 1e-13);
+  }
+  x = ConjugateGradientSolverAllReduce(dmat1, db1, dx01, 100, 1e-16, 20, iter, world, precond);
+  EXPECT_NEAR((x - dx_res1).NormSquare(), 0.0, 1e-13);
+}
+
 int main(int argc, char *argv[]) {
   testing::InitGoogleTest(&argc, argv);
   boost::mpi::environment env(boost::mpi::threading::multiple);
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for dense Jacobi eigen solver
+*/
+
+#include <random>
+#include "gqpeps/utility/hermitian_eigen_solver.h"
+#include "gtest/gtest.h"
+
+using namespace gqpeps;
+
+template<typename ElemT>
+ElemT RandomElem(std::mt19937 &engine);
+
+template<>
+double RandomElem<double>(std::mt19937 &engine) {
+  return std::uniform_real_distribution<double>(-1.0, 1.0)(engine);
+}
+
+template<>
+std::complex<double> RandomElem<std::complex<double>>(std::mt19937 &engine) {
+  std::uniform_real_distribution<double> u(-1.0, 1.0);
+  return std::complex<double>(u(engine), u(engine));
+}
+
+///< A V = V diag(w), V^dag V = 1 and the ascending eigenvalues
+template<typename ElemT>
+void CheckRandomHermitian(const size_t n) {
+  std::mt19937 engine(n);
+  std::vector<ElemT> a(n * n);
+  for (size_t k = 0; k < n; k++) {
+    a[k * n + k] = std::real(RandomElem<ElemT>(engine));
+    for (size_t l = k + 1; l < n; l++) {
+      a[k * n + l] = RandomElem<ElemT>(engine);
+      a[l * n + k] = ConjugateElem(a[k * n + l]);
+    }
+  }
+  std::vector<ElemT> a_copy = a;
+  std::vector<double> w;
+  std::vector<ElemT> v;
+  ASSERT_TRUE(HermitianEigen(a_copy, n, w, v));
+  for (size_t j = 0; j + 1 < n; j++) {
+    EXPECT_LE(w[j], w[j + 1]);
+  }
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j < n; j++) {
+      ElemT av(0), vdag_v(0);
+      for (size_t k = 0; k < n; k++) {
+        av += a[i * n + k] * v[k * n + j];
+        vdag_v += ConjugateElem(v[k * n + i]) * v[k * n + j];
+      }
+      EXPECT_NEAR(std::abs(av - w[j] * v[i * n + j]), 0.0, 1e-12);
+      EXPECT_NEAR(std::abs(vdag_v - ElemT(i == j ? 1.0 : 0.0)), 0.0, 1e-12);
+    }
+  }
+}
+
+TEST(TestHermitianEigenSolver, RealMatrix) {
+  std::vector<double> a = {2.0, 1.0,
+                           1.0, 2.0};
+  std::vector<double> w;
+  std::vector<double> v;
+  ASSERT_TRUE(HermitianEigen(a, 2, w, v));
+  EXPECT_NEAR(w[0], 1.0, 1e-14);
+  EXPECT_NEAR(w[1], 3.0, 1e-14);
+  EXPECT_NEAR(std::abs(v[0] + v[2]), 0.0, 1e-14);
+  CheckRandomHermitian<double>(7);
+}
+
+TEST(TestHermitianEigenSolver, ComplexMatrix) {
+  using Complex = std::complex<double>;
+  // eigenvalues 1 and 4
+  std::vector<Complex> a = {Complex(2.0, 0.0), Complex(1.0, 1.0),
+                            Complex(1.0, -1.0), Complex(3.0, 0.0)};
+  std::vector<double> w;
+  std::vector<Complex> v;
+  ASSERT_TRUE(HermitianEigen(a, 2, w, v));
+  EXPECT_NEAR(w[0], 1.0, 1e-14);
+  EXPECT_NEAR(w[1], 4.0, 1e-14);
+  CheckRandomHermitian<Complex>(6);
+}
+
+TEST(TestHermitianEigenSolver, NotFinite) {
+  std::vector<double> a = {1.0, std::nan(""),
+                           std::nan(""), 1.0};
+  std::vector<double> w;
+  std::vector<double> v;
+  EXPECT_FALSE(HermitianEigen(a, 2, w, v));
+}
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/*
+* Author: Hao-Xin Wang<wanghaoxin1996@gmail.com>
+* Creation Date: 2026-10-17
+*
+* Description: GraceQ/VMC-PEPS project. Unittests for the preemption signals and the walltime budget.
+*/
+
+#include <cmath>
+#include <csignal>
+#include <thread>
+#include "gqpeps/utility/preemption.h"
+#include "gtest/gtest.h"
+
+using namespace gqpeps;
+
+TEST(TestPreemption, TrappedSignal) {
+  TrapPreemptionSignals();
+  EXPECT_FALSE(PreemptionSignalReceived());
+  std::raise(SIGUSR1);
+  EXPECT_TRUE(PreemptionSignalReceived());
+  preemption_signal_received = 0;
+  std::raise(SIGTERM);
+  EXPECT_TRUE(PreemptionSignalReceived());
+  preemption_signal_received = 0;
+}
+
+TEST(TestPreemption, WalltimeBudget) {
+  WalltimeBudget unlimited;
+  EXPECT_FALSE(unlimited.Limited());
+  EXPECT_TRUE(std::isinf(unlimited.Remaining()));
+
+  WalltimeBudget budget(10.0);
+  EXPECT_TRUE(budget.Limited());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_GE(budget.Elapsed(), 0.02);
+  EXPECT_LE(budget.Remaining(), 10.0 - 0.02);
+  EXPECT_GT(budget.Remaining(), 0.0);
+}